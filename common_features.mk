@@ -139,6 +139,11 @@ ifeq ($(strip $(PRINTING_ENABLE)), yes)
     SRC += $(TMK_DIR)/protocol/serial_uart.c
 endif
 
+ifeq ($(strip $(SEND_STRING_QUEUE_ENABLE)), yes)
+    OPT_DEFS += -DSEND_STRING_QUEUE_ENABLE
+    SRC += $(QUANTUM_DIR)/send_string_queue.c
+endif
+
 ifeq ($(strip $(AUTO_SHIFT_ENABLE)), yes)
     OPT_DEFS += -DAUTO_SHIFT_ENABLE
     SRC += $(QUANTUM_DIR)/process_keycode/process_auto_shift.c
@@ -153,6 +158,13 @@ ifeq ($(strip $(SERIAL_LINK_ENABLE)), yes)
     VAPTH += $(SERIAL_PATH)
 endif
 
+ifeq ($(strip $(SPLIT_SERIAL_ENABLE)), yes)
+    OPT_DEFS += -DSPLIT_SERIAL_ENABLE
+    SRC += $(QUANTUM_DIR)/split_common/serial.c
+    SRC += $(QUANTUM_DIR)/split_common/serial_frame.c
+    VPATH += $(QUANTUM_PATH)/split_common
+endif
+
 ifneq ($(strip $(VARIABLE_TRACE)),)
     SRC += $(QUANTUM_DIR)/variable_trace.c
     OPT_DEFS += -DNUM_TRACED_VARIABLES=$(strip $(VARIABLE_TRACE))
@@ -201,8 +213,19 @@ QUANTUM_SRC:= \
     $(QUANTUM_DIR)/quantum.c \
     $(QUANTUM_DIR)/keymap_common.c \
     $(QUANTUM_DIR)/keycode_config.c \
+    $(QUANTUM_DIR)/deadline.c \
     $(QUANTUM_DIR)/process_keycode/process_leader.c
 
 ifndef CUSTOM_MATRIX
     QUANTUM_SRC += $(QUANTUM_DIR)/matrix.c
 endif
+
+DEBOUNCE_DIR := $(QUANTUM_DIR)/debounce
+DEBOUNCE_TYPE ?= sym_g
+VALID_DEBOUNCE_TYPES := sym_g sym_pk eager_pk eager_pr custom
+ifeq ($(filter $(strip $(DEBOUNCE_TYPE)),$(VALID_DEBOUNCE_TYPES)),)
+    $(error DEBOUNCE_TYPE="$(DEBOUNCE_TYPE)" is not a valid debounce algorithm)
+endif
+ifneq ($(strip $(DEBOUNCE_TYPE)), custom)
+    QUANTUM_SRC += $(DEBOUNCE_DIR)/$(strip $(DEBOUNCE_TYPE)).c
+endif
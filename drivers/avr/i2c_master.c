@@ -3,7 +3,10 @@
  */
 
 #include <avr/io.h>
+#include <avr/interrupt.h>
 #include <util/twi.h>
+#include <util/atomic.h>
+#include <stddef.h>
 
 #include "i2c_master.h"
 
@@ -11,6 +14,12 @@
 #define Prescaler 1
 #define TWBR_val ((((F_CPU / F_SCL) / Prescaler) - 16 ) / 2)
 
+static i2c_transaction_t* volatile i2c_current = NULL;
+static i2c_transaction_t* i2c_queue_head[I2C_LANE_COUNT];
+static i2c_transaction_t* i2c_queue_tail[I2C_LANE_COUNT];
+static uint16_t i2c_index;
+static bool i2c_register_pending;
+
 void i2c_init(void)
 {
 	TWBR = (uint8_t)TWBR_val;
@@ -18,6 +27,9 @@ void i2c_init(void)
 
 uint8_t i2c_start(uint8_t address)
 {
+	// let queued transactions finish first
+	while (i2c_busy());
+
 	// reset TWI control register
 	TWCR = 0;
 	// transmit START condition 
@@ -147,3 +159,139 @@ void i2c_stop(void)
 	// transmit STOP condition
 	TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWSTO);
 }
+
+bool i2c_busy(void)
+{
+	return i2c_current != NULL;
+}
+
+static i2c_transaction_t* i2c_dequeue(void)
+{
+	for (uint8_t lane = 0; lane < I2C_LANE_COUNT; lane++)
+	{
+		i2c_transaction_t* transaction = i2c_queue_head[lane];
+		if (transaction)
+		{
+			i2c_queue_head[lane] = transaction->next;
+			return transaction;
+		}
+	}
+	return NULL;
+}
+
+static void i2c_begin(i2c_transaction_t* transaction, uint8_t twcr)
+{
+	i2c_current = transaction;
+	i2c_index = 0;
+	i2c_register_pending = transaction->flags & I2C_TRANSACTION_REGISTER;
+	// transmit START condition, the rest happens in the interrupt
+	TWCR = twcr | (1<<TWINT) | (1<<TWSTA) | (1<<TWEN) | (1<<TWIE);
+}
+
+bool i2c_submit(i2c_transaction_t* transaction, i2c_lane_t lane)
+{
+	if (transaction->status == I2C_STATUS_PENDING) return false;
+
+	transaction->status = I2C_STATUS_PENDING;
+	transaction->next = NULL;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if (i2c_current == NULL)
+		{
+			i2c_begin(transaction, 0);
+		}
+		else
+		{
+			if (i2c_queue_head[lane]) i2c_queue_tail[lane]->next = transaction;
+			else i2c_queue_head[lane] = transaction;
+			i2c_queue_tail[lane] = transaction;
+		}
+	}
+	return true;
+}
+
+i2c_status_t i2c_wait(i2c_transaction_t* transaction)
+{
+	while (transaction->status == I2C_STATUS_PENDING);
+	return transaction->status;
+}
+
+static void i2c_finish(i2c_status_t status)
+{
+	i2c_transaction_t* transaction = i2c_current;
+	transaction->status = status;
+	if (transaction->callback) transaction->callback(transaction);
+
+	i2c_transaction_t* next = i2c_dequeue();
+	if (next)
+	{
+		// STOP followed by a new START
+		i2c_begin(next, (1<<TWSTO));
+	}
+	else
+	{
+		i2c_current = NULL;
+		TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWSTO);
+	}
+}
+
+static inline void i2c_continue(bool ack)
+{
+	TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWIE) | (ack ? (1<<TWEA) : 0);
+}
+
+ISR(TWI_vect)
+{
+	i2c_transaction_t* transaction = i2c_current;
+	bool read = transaction->flags & I2C_TRANSACTION_READ;
+
+	switch (TW_STATUS)
+	{
+	case TW_START:
+		TWDR = transaction->address | ((read && !i2c_register_pending) ? I2C_READ : I2C_WRITE);
+		i2c_continue(false);
+		break;
+	case TW_REP_START:
+		TWDR = transaction->address | I2C_READ;
+		i2c_continue(false);
+		break;
+	case TW_MT_SLA_ACK:
+	case TW_MT_DATA_ACK:
+		if (i2c_register_pending)
+		{
+			i2c_register_pending = false;
+			TWDR = transaction->reg;
+			i2c_continue(false);
+		}
+		else if (read)
+		{
+			// register written, now read it with a repeated START
+			TWCR = (1<<TWINT) | (1<<TWSTA) | (1<<TWEN) | (1<<TWIE);
+		}
+		else if (i2c_index < transaction->length)
+		{
+			TWDR = transaction->data[i2c_index++];
+			i2c_continue(false);
+		}
+		else
+		{
+			i2c_finish(I2C_STATUS_DONE);
+		}
+		break;
+	case TW_MR_DATA_ACK:
+		transaction->data[i2c_index++] = TWDR;
+		// fall through
+	case TW_MR_SLA_ACK:
+		// acknowledge everything but the last byte
+		i2c_continue(i2c_index + 1 < transaction->length);
+		break;
+	case TW_MR_DATA_NACK:
+		transaction->data[i2c_index++] = TWDR;
+		i2c_finish(I2C_STATUS_DONE);
+		break;
+	default:
+		// NACK or lost arbitration
+		i2c_finish(I2C_STATUS_ERROR);
+		break;
+	}
+}
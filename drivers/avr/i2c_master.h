@@ -5,6 +5,9 @@
 #ifndef I2C_MASTER_H
 #define I2C_MASTER_H
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #define I2C_READ 0x01
 #define I2C_WRITE 0x00
 
@@ -19,4 +22,48 @@ uint8_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t l
 uint8_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length);
 void i2c_stop(void);
 
+// Asynchronous transactions
+//
+// Transactions are queued and run from the TWI interrupt, so submitting
+// one doesn't block. The priority lane is always served before the bulk
+// lane, so short latency sensitive transfers like matrix reads only wait
+// for the transaction currently on the bus, not for queued LED updates.
+// The blocking functions above wait until the queue is empty.
+
+#define I2C_TRANSACTION_READ     (1 << 0)
+// Write reg before the data, with a repeated start for reads
+#define I2C_TRANSACTION_REGISTER (1 << 1)
+
+typedef enum {
+	I2C_STATUS_DONE = 0,
+	I2C_STATUS_ERROR,
+	I2C_STATUS_PENDING,
+} i2c_status_t;
+
+typedef enum {
+	I2C_LANE_PRIORITY = 0,
+	I2C_LANE_BULK,
+	I2C_LANE_COUNT,
+} i2c_lane_t;
+
+typedef struct i2c_transaction {
+	// Same as for i2c_start, without the read bit
+	uint8_t address;
+	uint8_t flags;
+	uint8_t reg;
+	uint8_t* data;
+	uint16_t length;
+	// Called from the interrupt when the transaction has finished, it
+	// may submit new transactions
+	void (*callback)(struct i2c_transaction* transaction);
+	volatile i2c_status_t status;
+	struct i2c_transaction* next;
+} i2c_transaction_t;
+
+// The transaction must stay valid until it has finished. Returns false if
+// it's already pending
+bool i2c_submit(i2c_transaction_t* transaction, i2c_lane_t lane);
+i2c_status_t i2c_wait(i2c_transaction_t* transaction);
+bool i2c_busy(void);
+
 #endif // I2C_MASTER_H
@@ -49,6 +49,15 @@
 #define ISSI_COMMANDREGISTER 0xFD
 #define ISSI_BANK_FUNCTIONREG 0x0B    // helpfully called 'page nine'
 
+// Number of attempts for each I2C transfer before giving up, so that a
+// missing or hung driver doesn't lock up the keyboard
+#ifndef ISSI_PERSISTENCE
+  #define ISSI_PERSISTENCE 8
+#endif
+
+#define ISSI_PWM_BLOCK_SIZE 16
+#define ISSI_PWM_BLOCK_COUNT (144 / ISSI_PWM_BLOCK_SIZE)
+
 // Transfer buffer for TWITransmitData()
 uint8_t g_twi_transfer_buffer[20];
 
@@ -58,7 +67,18 @@ uint8_t g_twi_transfer_buffer[20];
 // buffers and the transfers in IS31FL3731_write_pwm_buffer() but it's
 // probably not worth the extra complexity.
 uint8_t g_pwm_buffer[DRIVER_COUNT][144];
-bool g_pwm_buffer_update_required = false;
+// One flag for each 16 byte block of g_pwm_buffer that has changed since
+// it was last sent, so only those blocks are transferred. They are bytes
+// rather than bits so the I2C interrupt can clear them without racing
+// IS31FL3731_set_color()
+volatile bool g_pwm_buffer_dirty[DRIVER_COUNT][ISSI_PWM_BLOCK_COUNT];
+
+// The dirty blocks of a driver are sent one after the other from the I2C
+// interrupt, so updating the LEDs doesn't block the matrix scan
+static i2c_transaction_t g_pwm_transaction[DRIVER_COUNT];
+static uint8_t g_pwm_transfer_buffer[DRIVER_COUNT][ISSI_PWM_BLOCK_SIZE];
+static uint8_t g_pwm_transfer_block[DRIVER_COUNT];
+static uint8_t g_pwm_transfer_attempts[DRIVER_COUNT];
 
 uint8_t g_led_control_registers[DRIVER_COUNT][18] = { { 0 }, { 0 } };
 bool g_led_control_registers_update_required = false;
@@ -83,32 +103,41 @@ void IS31FL3731_write_register( uint8_t addr, uint8_t reg, uint8_t data )
 	g_twi_transfer_buffer[0] = reg;
 	g_twi_transfer_buffer[1] = data;
 
-	//Transmit data until succesful
-	while(i2c_transmit(addr << 1, g_twi_transfer_buffer,2) != 0); 
+	for ( uint8_t i = 0; i < ISSI_PERSISTENCE; i++ )
+	{
+		if ( i2c_transmit(addr << 1, g_twi_transfer_buffer, 2) == 0 ) {
+			break;
+		}
+	}
 }
 
-void IS31FL3731_write_pwm_buffer( uint8_t addr, uint8_t *pwm_buffer )
+static bool IS31FL3731_write_pwm_block( uint8_t addr, uint8_t *pwm_buffer, uint8_t block )
 {
 	// assumes bank is already selected
+	uint8_t offset = block * ISSI_PWM_BLOCK_SIZE;
 
-	// transmit PWM registers in 9 transfers of 16 bytes
-	// g_twi_transfer_buffer[] is 20 bytes
+	// set the first register, e.g. 0x24, 0x34, 0x44, etc.
+	g_twi_transfer_buffer[0] = 0x24 + offset;
+	// device will auto-increment register for data after the first byte
+	// thus this sets registers 0x24-0x33, 0x34-0x43, etc. in one transfer
+	memcpy( g_twi_transfer_buffer + 1, pwm_buffer + offset, ISSI_PWM_BLOCK_SIZE );
 
-	// iterate over the pwm_buffer contents at 16 byte intervals
-	for ( int i = 0; i < 144; i += 16 )
+	for ( uint8_t i = 0; i < ISSI_PERSISTENCE; i++ )
 	{
-		// set the first register, e.g. 0x24, 0x34, 0x44, etc.
-		g_twi_transfer_buffer[0] = 0x24 + i;
-		// copy the data from i to i+15
-		// device will auto-increment register for data after the first byte
-		// thus this sets registers 0x24-0x33, 0x34-0x43, etc. in one transfer
-		for ( int j = 0; j < 16; j++ )
-		{
-			g_twi_transfer_buffer[1 + j] = pwm_buffer[i + j];
+		if ( i2c_transmit(addr << 1, g_twi_transfer_buffer, ISSI_PWM_BLOCK_SIZE + 1) == 0 ) {
+			return true;
 		}
+	}
+	return false;
+}
 
-		//Transmit buffer until succesful
-		while(i2c_transmit(addr << 1, g_twi_transfer_buffer,17) != 0);
+void IS31FL3731_write_pwm_buffer( uint8_t addr, uint8_t *pwm_buffer )
+{
+	// transmit PWM registers in 9 transfers of 16 bytes
+	// g_twi_transfer_buffer[] is 20 bytes
+	for ( uint8_t block = 0; block < ISSI_PWM_BLOCK_COUNT; block++ )
+	{
+		IS31FL3731_write_pwm_block( addr, pwm_buffer, block );
 	}
 }
 
@@ -167,16 +196,24 @@ void IS31FL3731_init( uint8_t addr )
 	IS31FL3731_write_register( addr, ISSI_COMMANDREGISTER, 0 );
 }
 
+static inline void IS31FL3731_set_pwm( uint8_t driver, uint8_t reg, uint8_t value )
+{
+	// Subtract 0x24 to get the second index of g_pwm_buffer
+	uint8_t offset = reg - 0x24;
+	if ( g_pwm_buffer[driver][offset] != value ) {
+		g_pwm_buffer[driver][offset] = value;
+		g_pwm_buffer_dirty[driver][offset / ISSI_PWM_BLOCK_SIZE] = true;
+	}
+}
+
 void IS31FL3731_set_color( int index, uint8_t red, uint8_t green, uint8_t blue )
 {
 	if ( index >= 0 && index < DRIVER_LED_TOTAL ) {
 		is31_led led = g_is31_leds[index];
 
-		// Subtract 0x24 to get the second index of g_pwm_buffer
-		g_pwm_buffer[led.driver][led.r - 0x24] = red;
-		g_pwm_buffer[led.driver][led.g - 0x24] = green;
-		g_pwm_buffer[led.driver][led.b - 0x24] = blue;
-		g_pwm_buffer_update_required = true;
+		IS31FL3731_set_pwm( led.driver, led.r, red );
+		IS31FL3731_set_pwm( led.driver, led.g, green );
+		IS31FL3731_set_pwm( led.driver, led.b, blue );
 	}
 }
 
@@ -220,14 +257,59 @@ void IS31FL3731_set_led_control_register( uint8_t index, bool red, bool green, b
 
 }
 
+static void IS31FL3731_submit_next_pwm_block( uint8_t driver )
+{
+	// continue after the last block sent, so that a block which changes
+	// on every frame can't starve the others
+	for ( uint8_t i = 1; i <= ISSI_PWM_BLOCK_COUNT; i++ )
+	{
+		uint8_t block = (g_pwm_transfer_block[driver] + i) % ISSI_PWM_BLOCK_COUNT;
+		if ( g_pwm_buffer_dirty[driver][block] ) {
+			uint8_t offset = block * ISSI_PWM_BLOCK_SIZE;
+			g_pwm_buffer_dirty[driver][block] = false;
+			memcpy( g_pwm_transfer_buffer[driver], g_pwm_buffer[driver] + offset, ISSI_PWM_BLOCK_SIZE );
+			g_pwm_transaction[driver].reg = 0x24 + offset;
+			g_pwm_transfer_block[driver] = block;
+			g_pwm_transfer_attempts[driver] = 0;
+			i2c_submit( &g_pwm_transaction[driver], I2C_LANE_BULK );
+			return;
+		}
+	}
+}
+
+static void IS31FL3731_pwm_block_sent( i2c_transaction_t *transaction )
+{
+	uint8_t driver = transaction - g_pwm_transaction;
+
+	if ( transaction->status == I2C_STATUS_ERROR ) {
+		if ( ++g_pwm_transfer_attempts[driver] < ISSI_PERSISTENCE ) {
+			i2c_submit( transaction, I2C_LANE_BULK );
+		} else {
+			// give up for now and send the block again on the next update
+			g_pwm_buffer_dirty[driver][g_pwm_transfer_block[driver]] = true;
+		}
+		return;
+	}
+	IS31FL3731_submit_next_pwm_block( driver );
+}
+
 void IS31FL3731_update_pwm_buffers( uint8_t addr1, uint8_t addr2 )
 {
-	if ( g_pwm_buffer_update_required )
+	uint8_t addr[2] = { addr1, addr2 };
+	for ( uint8_t driver = 0; driver < 2; driver++ )
 	{
-		IS31FL3731_write_pwm_buffer( addr1, g_pwm_buffer[0] );
-		IS31FL3731_write_pwm_buffer( addr2, g_pwm_buffer[1] );
+		i2c_transaction_t *transaction = &g_pwm_transaction[driver];
+		if ( transaction->status == I2C_STATUS_PENDING ) {
+			// still sending the blocks from an earlier update
+			continue;
+		}
+		transaction->address = addr[driver] << 1;
+		transaction->flags = I2C_TRANSACTION_REGISTER;
+		transaction->data = g_pwm_transfer_buffer[driver];
+		transaction->length = ISSI_PWM_BLOCK_SIZE;
+		transaction->callback = IS31FL3731_pwm_block_sent;
+		IS31FL3731_submit_next_pwm_block( driver );
 	}
-	g_pwm_buffer_update_required = false;
 }
 
 void IS31FL3731_update_led_control_registers( uint8_t addr1, uint8_t addr2 )
@@ -239,6 +321,7 @@ void IS31FL3731_update_led_control_registers( uint8_t addr1, uint8_t addr2 )
 			IS31FL3731_write_register(addr1, i, g_led_control_registers[0][i] );
 			IS31FL3731_write_register(addr2, i, g_led_control_registers[1][i] );
 		}
+		g_led_control_registers_update_required = false;
 	}
 }
 
@@ -26,6 +26,7 @@
 #include <avr/io.h>
 #include <util/delay.h>
 #include "debug.h"
+#include "timer.h"
 
 #ifdef RGBW_BB_TWI
 
@@ -141,6 +142,25 @@ unsigned char I2C_Write(unsigned char c)
 
 #endif
 
+// The strip latches a frame once the data line has been low for the reset
+// time. Instead of waiting that out after every frame, only wait before the
+// next frame when it follows straight after the previous one.
+static bool     ws2812_frame_sent = false;
+static uint16_t ws2812_frame_time;
+
+static inline bool ws2812_reset_pending(void)
+{
+  // timer_read() counts whole milliseconds, so one tick may be less than
+  // the reset time
+  return ws2812_frame_sent && timer_elapsed(ws2812_frame_time) < 2;
+}
+
+static inline void ws2812_frame_done(void)
+{
+  ws2812_frame_time = timer_read();
+  ws2812_frame_sent = true;
+}
+
 // Setleds for standard RGB
 void inline ws2812_setleds(LED_TYPE *ledarray, uint16_t leds)
 {
@@ -154,8 +174,11 @@ void inline ws2812_setleds_pin(LED_TYPE *ledarray, uint16_t leds, uint8_t pinmas
   // new universal format (DDR)
   _SFR_IO8((RGB_DI_PIN >> 4) + 1) |= pinmask;
 
+  if (ws2812_reset_pending()) {
+    _delay_us(50);
+  }
   ws2812_sendarray_mask((uint8_t*)ledarray,leds+leds+leds,pinmask);
-  _delay_us(50);
+  ws2812_frame_done();
 }
 
 // Setleds for SK6812RGBW
@@ -188,12 +211,13 @@ void inline ws2812_setleds_rgbw(LED_TYPE *ledarray, uint16_t leds)
   // new universal format (DDR)
   _SFR_IO8((RGB_DI_PIN >> 4) + 1) |= _BV(RGB_DI_PIN & 0xF);
 
-  ws2812_sendarray_mask((uint8_t*)ledarray,leds<<2,_BV(RGB_DI_PIN & 0xF));
-
-
   #ifndef RGBW_BB_TWI
-    _delay_us(80);
+    if (ws2812_reset_pending()) {
+      _delay_us(80);
+    }
   #endif
+  ws2812_sendarray_mask((uint8_t*)ledarray,leds<<2,_BV(RGB_DI_PIN & 0xF));
+  ws2812_frame_done();
 }
 
 void ws2812_sendarray(uint8_t *data,uint16_t datlen)
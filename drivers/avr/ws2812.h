@@ -41,7 +41,7 @@
  * The functions will perform the following actions:
  *         - Set the data-out pin as output
  *         - Send out the LED data
- *         - Wait 50�s to reset the LEDs
+ *         - Make sure the LEDs were reset (50us low) since the previous frame
  */
 
 void ws2812_setleds     (LED_TYPE *ledarray, uint16_t number_of_leds);
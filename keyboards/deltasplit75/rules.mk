@@ -1,7 +1,6 @@
 SRC += matrix.c \
 	   i2c.c \
-	   split_util.c \
-	   serial.c
+	   split_util.c
 
 # MCU name
 #MCU = at90usb1287
@@ -70,5 +69,6 @@ USE_I2C = yes
 SLEEP_LED_ENABLE = no    # Breathing sleep LED during USB suspend
 
 CUSTOM_MATRIX = yes
+SPLIT_SERIAL_ENABLE = yes
 
 DEFAULT_FOLDER = deltasplit75/v2
\ No newline at end of file
@@ -1,5 +1,4 @@
 SRC += ../lets_split/matrix.c \
-	   ../lets_split/serial.c \
 	   ../lets_split/split_util.c
 
 # MCU name
@@ -71,3 +70,4 @@ RGBLIGHT_ENABLE = no       # Enable WS2812 RGB underlight.  Do not enable this w
 # Do not enable SLEEP_LED_ENABLE. it uses the same timer as BACKLIGHT_ENABLE
 SLEEP_LED_ENABLE = no    # Breathing sleep LED during USB suspend
 CUSTOM_MATRIX = yes
+SPLIT_SERIAL_ENABLE = yes
@@ -86,17 +86,17 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #define RGBW 1
 
-/* "debounce" is measured in keyboard scans. Some users reported
- * needing values as high as 15, which was at the time around 50ms.
- * If you don't define it here, the matrix code will default to
- * 5, which is now closer to 10ms, but still plenty according to
- * manufacturer specs.
+/* "debounce" is the lockout time in msecs of the per-key eager
+ * debounce (DEBOUNCE_TYPE = eager_pk in rules.mk). Changes are reported
+ * as soon as they are seen, so this no longer adds latency to presses;
+ * it only limits how soon the same key can change again.
  *
- * Default is quite high, because of reports with some production
- * runs seeming to need it. This may change when configuration for
- * this is more directly exposed.
+ * It used to be measured in keyboard scans, where some users reported
+ * needing values as high as 15. Default is quite high, because of
+ * reports with some production runs seeming to need it.
  */
 #define DEBOUNCE    15
+#define DEBOUNCING_DELAY DEBOUNCE
 
 #define PREVENT_STUCK_MODIFIERS
 
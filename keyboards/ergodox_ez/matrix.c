@@ -35,34 +35,21 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "matrix.h"
 #include QMK_KEYBOARD_H
 #include "i2cmaster.h"
+#include "debounce.h"
 #ifdef DEBUG_MATRIX_SCAN_RATE
 #include  "timer.h"
 #endif
 
 /*
- * This constant define not debouncing time in msecs, but amount of matrix
- * scan loops which should be made to get stable debounced results.
- *
- * On Ergodox matrix scan rate is relatively low, because of slow I2C.
- * Now it's only 317 scans/second, or about 3.15 msec/scan.
- * According to Cherry specs, debouncing time is 5 msec.
- *
- * However, some switches seem to have higher debouncing requirements, or
- * something else might be wrong. (Also, the scan speed has improved since
- * that comment was written.)
+ * Debouncing is done by the per-key eager algorithm in quantum/debounce
+ * (DEBOUNCE_TYPE = eager_pk in rules.mk): a change is reported as soon as it
+ * is seen, and the key then ignores further changes for DEBOUNCE msecs.
+ * See config.h.
  */
 
-#ifndef DEBOUNCE
-#   define DEBOUNCE	5
-#endif
-
 /* matrix state(1:on, 0:off) */
-static matrix_row_t matrix[MATRIX_ROWS];
-
-// Debouncing: store for each key the number of scans until it's eligible to
-// change.  When scanning the matrix, ignore any changes in keys that have
-// already changed in the last DEBOUNCE scans.
-static uint8_t debounce_matrix[MATRIX_ROWS * MATRIX_COLS];
+static matrix_row_t raw_matrix[MATRIX_ROWS]; //raw values
+static matrix_row_t matrix[MATRIX_ROWS]; //debounced values
 
 static matrix_row_t read_cols(uint8_t row);
 static void init_cols(void);
@@ -117,12 +104,12 @@ void matrix_init(void)
 
     // initialize matrix state: all keys off
     for (uint8_t i=0; i < MATRIX_ROWS; i++) {
+        raw_matrix[i] = 0;
         matrix[i] = 0;
-        for (uint8_t j=0; j < MATRIX_COLS; ++j) {
-            debounce_matrix[i * MATRIX_COLS + j] = 0;
-        }
     }
 
+    debounce_init(MATRIX_ROWS);
+
 #ifdef DEBUG_MATRIX_SCAN_RATE
     matrix_timer = timer_read32();
     matrix_scan_count = 0;
@@ -140,6 +127,7 @@ void matrix_power_up(void) {
 
     // initialize matrix state: all keys off
     for (uint8_t i=0; i < MATRIX_ROWS; i++) {
+        raw_matrix[i] = 0;
         matrix[i] = 0;
     }
 
@@ -149,30 +137,6 @@ void matrix_power_up(void) {
 #endif
 }
 
-// Returns a matrix_row_t whose bits are set if the corresponding key should be
-// eligible to change in this scan.
-matrix_row_t debounce_mask(uint8_t row) {
-  matrix_row_t result = 0;
-  for (uint8_t j=0; j < MATRIX_COLS; ++j) {
-    if (debounce_matrix[row * MATRIX_COLS + j]) {
-      --debounce_matrix[row * MATRIX_COLS + j];
-    } else {
-      result |= (1 << j);
-    }
-  }
-  return result;
-}
-
-// Report changed keys in the given row.  Resets the debounce countdowns
-// corresponding to each set bit in 'change' to DEBOUNCE.
-void debounce_report(matrix_row_t change, uint8_t row) {
-  for (uint8_t i = 0; i < MATRIX_COLS; ++i) {
-    if (change & (1 << i)) {
-      debounce_matrix[row * MATRIX_COLS + i] = DEBOUNCE;
-    }
-  }
-}
-
 uint8_t matrix_scan(void)
 {
     if (mcp23018_status) { // if there was an error
@@ -207,24 +171,25 @@ uint8_t matrix_scan(void)
 #ifdef LEFT_LEDS
     mcp23018_status = ergodox_left_leds_update();
 #endif // LEFT_LEDS
+    bool changed = false;
     for (uint8_t i = 0; i < MATRIX_ROWS_PER_SIDE; i++) {
         select_row(i);
         // and select on left hand
         select_row(i + MATRIX_ROWS_PER_SIDE);
         // we don't need a 30us delay anymore, because selecting a
         // left-hand row requires more than 30us for i2c.
-        matrix_row_t mask = debounce_mask(i);
-        matrix_row_t cols = (read_cols(i) & mask) | (matrix[i] & ~mask);
-        debounce_report(cols ^ matrix[i], i);
-        matrix[i] = cols;
+        matrix_row_t cols = read_cols(i);
+        changed |= (cols != raw_matrix[i]);
+        raw_matrix[i] = cols;
         // grab cols from right hand
-        mask = debounce_mask(i + MATRIX_ROWS_PER_SIDE);
-        cols = (read_cols(i + MATRIX_ROWS_PER_SIDE) & mask) | (matrix[i + MATRIX_ROWS_PER_SIDE] & ~mask);
-        debounce_report(cols ^ matrix[i + MATRIX_ROWS_PER_SIDE], i + MATRIX_ROWS_PER_SIDE);
-        matrix[i + MATRIX_ROWS_PER_SIDE] = cols;
+        cols = read_cols(i + MATRIX_ROWS_PER_SIDE);
+        changed |= (cols != raw_matrix[i + MATRIX_ROWS_PER_SIDE]);
+        raw_matrix[i + MATRIX_ROWS_PER_SIDE] = cols;
         unselect_rows();
     }
 
+    debounce(raw_matrix, matrix, MATRIX_ROWS, changed);
+
     matrix_scan_quantum();
 
     return 1;
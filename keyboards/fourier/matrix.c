@@ -283,6 +283,7 @@ void matrix_slave_scan(void) {
     for (int i = 0; i < ROWS_PER_HAND; ++i) {
         serial_slave_buffer[i] = matrix[offset+i];
     }
+    serial_update_buffers();
 
 #ifdef BACKLIGHT_ENABLE
     // Read backlight level sent from master and update level on slave
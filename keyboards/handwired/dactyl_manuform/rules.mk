@@ -1,7 +1,6 @@
 SRC += matrix.c \
 	   i2c.c \
 	   split_util.c \
-	   serial.c \
 	   ssd1306.c
 
 # MCU name
@@ -71,5 +70,6 @@ USE_I2C = yes
 SLEEP_LED_ENABLE = no    # Breathing sleep LED during USB suspend
 
 CUSTOM_MATRIX = yes
+SPLIT_SERIAL_ENABLE = yes
 
 LAYOUTS = ortho_4x12
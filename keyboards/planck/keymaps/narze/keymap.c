@@ -274,6 +274,7 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
         persistant_default_layer_set(1UL<<_QWERTY);
 
         key_combos[CB_SUPERDUPER].keys = superduper_combos[_QWERTY];
+        combo_index_invalidate();
         eeprom_update_byte(EECONFIG_SUPERDUPER_INDEX, _QWERTY);
       }
       return false;
@@ -286,6 +287,7 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
         persistant_default_layer_set(1UL<<_COLEMAK);
 
         key_combos[CB_SUPERDUPER].keys = superduper_combos[_COLEMAK];
+        combo_index_invalidate();
         eeprom_update_byte(EECONFIG_SUPERDUPER_INDEX, _COLEMAK);
       }
       return false;
@@ -298,6 +300,7 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
         persistant_default_layer_set(1UL<<_QWOC);
 
         key_combos[CB_SUPERDUPER].keys = superduper_combos[_QWOC];
+        combo_index_invalidate();
         eeprom_update_byte(EECONFIG_SUPERDUPER_INDEX, _QWOC);
       }
       return false;
@@ -405,10 +408,12 @@ void set_superduper_key_combos(void) {
       key_combos[CB_SUPERDUPER].keys = superduper_combos[layer];
       break;
   }
+  combo_index_invalidate();
 }
 
 void clear_superduper_key_combos(void) {
   key_combos[CB_SUPERDUPER].keys = empty_combo;
+  combo_index_invalidate();
 }
 
 void matrix_scan_user(void) {
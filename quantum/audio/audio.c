@@ -14,6 +14,9 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+// The built-in songs below are kept in flash as compact notes
+#define AUDIO_COMPACT_SONGS
+
 #include <stdio.h>
 #include <string.h>
 //#include <math.h>
@@ -113,30 +116,34 @@
 // -----------------------------------------------------------------------------
 
 
+// The timer interrupts run once per period of the note being played, so
+// they only use integer math. Notes are kept as timer periods (see
+// AUDIO_TICK_RATE), and durations as the number of timer ticks played.
 int voices = 0;
 int voice_place = 0;
-float frequency = 0;
-float frequency_alt = 0;
+uint16_t period = 0;
+uint16_t period_alt = 0;
 int volume = 0;
 long position = 0;
 
-float frequencies[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+uint16_t periods[8] = {0, 0, 0, 0, 0, 0, 0, 0};
 int volumes[8] = {0, 0, 0, 0, 0, 0, 0, 0};
 bool sliding = false;
 
-float place = 0;
+uint32_t place = 0;
 
 uint8_t * sample;
 uint16_t sample_length = 0;
 
 bool     playing_notes = false;
 bool     playing_note = false;
-float    note_frequency = 0;
-float    note_length = 0;
+uint16_t note_period = 0;
+uint32_t note_ticks = 0;
 uint8_t  note_tempo = TEMPO_DEFAULT;
-float    note_timbre = TIMBRE_DEFAULT;
-uint16_t note_position = 0;
+uint8_t  note_timbre = TIMBRE_DUTY(TIMBRE_DEFAULT);
+uint32_t note_position = 0;
 float (* notes_pointer)[][2];
+const compact_note_t *compact_notes_pointer = NULL;
 uint16_t notes_count;
 bool     notes_repeat;
 bool     note_resting = false;
@@ -145,12 +152,16 @@ uint8_t current_note = 0;
 uint8_t rest_counter = 0;
 
 #ifdef VIBRATO_ENABLE
-float vibrato_counter = 0;
-float vibrato_strength = .5;
-float vibrato_rate = 0.125;
+// position in vibrato_period_lut and entries to advance per interrupt, out of 256
+uint16_t vibrato_counter = 0;
+uint16_t vibrato_rate = 0.125 * 256;
+// out of 256
+uint16_t vibrato_strength = .5 * 256;
 #endif
 
 float polyphony_rate = 0;
+// ticks to play each voice for when polyphony_rate is set
+uint32_t polyphony_ticks = 0;
 
 static bool audio_initialized = false;
 
@@ -159,6 +170,75 @@ audio_config_t audio_config;
 uint16_t envelope_index = 0;
 bool glissando = true;
 
+// Rests are timed with the output silent and interrupts every millisecond
+#define REST_PERIOD (AUDIO_TICK_RATE / 1000)
+
+static uint16_t frequency_to_period(float freq)
+{
+    if (freq * UINT16_MAX < AUDIO_TICK_RATE) {
+        return UINT16_MAX;
+    }
+    return AUDIO_TICK_RATE / freq + 0.5f;
+}
+
+static uint32_t note_length_to_ticks(float length)
+{
+    return (length / 4) * (((float)note_tempo) / 100) * 0xFFFF;
+}
+
+static uint16_t timbre_duty_cycle(uint16_t timer_period) {
+    return ((uint32_t)timer_period * note_timbre) >> 8;
+}
+
+// Timer periods of the octave starting at C2 (MIDI notes 36 to 47), other
+// octaves are shifted from these
+#define OCTAVE_PERIOD(freq) ((uint16_t)(AUDIO_TICK_RATE / (freq) + 0.5))
+#define PERIOD_LUT_OCTAVE   3
+
+static const uint16_t note_period_lut[12] PROGMEM = {
+    OCTAVE_PERIOD(65.406),  OCTAVE_PERIOD(69.296),  OCTAVE_PERIOD(73.416),
+    OCTAVE_PERIOD(77.782),  OCTAVE_PERIOD(82.407),  OCTAVE_PERIOD(87.307),
+    OCTAVE_PERIOD(92.499),  OCTAVE_PERIOD(97.999),  OCTAVE_PERIOD(103.826),
+    OCTAVE_PERIOD(110.000), OCTAVE_PERIOD(116.541), OCTAVE_PERIOD(123.471)
+};
+
+static uint16_t midi_note_to_period(uint8_t note)
+{
+    uint8_t octave = note / 12;
+    uint32_t period = pgm_read_word(&note_period_lut[note % 12]);
+
+    if (octave >= PERIOD_LUT_OCTAVE) {
+        uint8_t shift = octave - PERIOD_LUT_OCTAVE;
+        return shift ? (period + (1 << (shift - 1))) >> shift : period;
+    }
+    period <<= PERIOD_LUT_OCTAVE - octave;
+    return period > UINT16_MAX ? UINT16_MAX : period;
+}
+
+static void load_note(void)
+{
+    if (compact_notes_pointer) {
+        uint8_t note = pgm_read_byte(&compact_notes_pointer[current_note].note);
+        uint8_t duration = pgm_read_byte(&compact_notes_pointer[current_note].duration);
+        note_period = note > 0 ? midi_note_to_period(note) : 0;
+        note_ticks = (uint32_t)duration * note_tempo * 0xFFFF / 400;
+        return;
+    }
+    float freq = (*notes_pointer)[current_note][0];
+    note_period = freq > 0 ? frequency_to_period(freq) : 0;
+    note_ticks = note_length_to_ticks((*notes_pointer)[current_note][1]);
+}
+
+// Whether the note after the current one has the same pitch
+static bool next_note_repeats(void)
+{
+    if (compact_notes_pointer) {
+        return pgm_read_byte(&compact_notes_pointer[current_note].note) ==
+               pgm_read_byte(&compact_notes_pointer[current_note + 1].note);
+    }
+    return (*notes_pointer)[current_note][0] == (*notes_pointer)[current_note + 1][0];
+}
+
 #ifndef STARTUP_SONG
     #define STARTUP_SONG SONG(STARTUP_SOUND)
 #endif
@@ -168,9 +248,9 @@ bool glissando = true;
 #ifndef AUDIO_OFF_SONG
     #define AUDIO_OFF_SONG SONG(AUDIO_OFF_SOUND)
 #endif
-float startup_song[][2] = STARTUP_SONG;
-float audio_on_song[][2] = AUDIO_ON_SONG;
-float audio_off_song[][2] = AUDIO_OFF_SONG;
+const compact_note_t startup_song[] PROGMEM = STARTUP_SONG;
+const compact_note_t audio_on_song[] PROGMEM = AUDIO_ON_SONG;
+const compact_note_t audio_off_song[] PROGMEM = AUDIO_OFF_SONG;
 
 void audio_init()
 {
@@ -215,14 +295,14 @@ void audio_init()
         #ifdef CPIN_AUDIO
             INIT_AUDIO_COUNTER_3
             TCCR3B = (1 << WGM33)  | (1 << WGM32)  | (0 << CS32)  | (1 << CS31) | (0 << CS30);
-            TIMER_3_PERIOD = (uint16_t)(((float)F_CPU) / (440 * CPU_PRESCALER));
-            TIMER_3_DUTY_CYCLE = (uint16_t)((((float)F_CPU) / (440 * CPU_PRESCALER)) * note_timbre);
+            TIMER_3_PERIOD = AUDIO_TICK_RATE / 440;
+            TIMER_3_DUTY_CYCLE = timbre_duty_cycle(AUDIO_TICK_RATE / 440);
         #endif
         #ifdef BPIN_AUDIO
             INIT_AUDIO_COUNTER_1
             TCCR1B = (1 << WGM13)  | (1 << WGM12)  | (0 << CS12)  | (1 << CS11) | (0 << CS10);
-            TIMER_1_PERIOD = (uint16_t)(((float)F_CPU) / (440 * CPU_PRESCALER));
-            TIMER_1_DUTY_CYCLE = (uint16_t)((((float)F_CPU) / (440 * CPU_PRESCALER)) * note_timbre);
+            TIMER_1_PERIOD = AUDIO_TICK_RATE / 440;
+            TIMER_1_DUTY_CYCLE = timbre_duty_cycle(AUDIO_TICK_RATE / 440);
         #endif 
 
         audio_initialized = true;
@@ -255,13 +335,13 @@ void stop_all_notes()
 
     playing_notes = false;
     playing_note = false;
-    frequency = 0;
-    frequency_alt = 0;
+    period = 0;
+    period_alt = 0;
     volume = 0;
 
     for (uint8_t i = 0; i < 8; i++)
     {
-        frequencies[i] = 0;
+        periods[i] = 0;
         volumes[i] = 0;
     }
 }
@@ -274,13 +354,14 @@ void stop_note(float freq)
         if (!audio_initialized) {
             audio_init();
         }
+        uint16_t freq_period = frequency_to_period(freq);
         for (int i = 7; i >= 0; i--) {
-            if (frequencies[i] == freq) {
-                frequencies[i] = 0;
+            if (periods[i] == freq_period) {
+                periods[i] = 0;
                 volumes[i] = 0;
                 for (int j = i; (j < 7); j++) {
-                    frequencies[j] = frequencies[j+1];
-                    frequencies[j+1] = 0;
+                    periods[j] = periods[j+1];
+                    periods[j+1] = 0;
                     volumes[j] = volumes[j+1];
                     volumes[j+1] = 0;
                 }
@@ -302,8 +383,8 @@ void stop_note(float freq)
                 DISABLE_AUDIO_COUNTER_1_ISR;
                 DISABLE_AUDIO_COUNTER_1_OUTPUT;
             #endif
-            frequency = 0;
-            frequency_alt = 0;
+            period = 0;
+            period_alt = 0;
             volume = 0;
             playing_note = false;
         }
@@ -312,193 +393,138 @@ void stop_note(float freq)
 
 #ifdef VIBRATO_ENABLE
 
-float mod(float a, int b)
-{
-    float r = fmod(a, b);
-    return r < 0 ? r + b : r;
-}
+// 440 / AUDIO_TICK_RATE out of 1 << 24, the vibrato runs faster for higher notes
+#define VIBRATO_SCALE ((uint32_t)(440.0 * (1UL << 24) / AUDIO_TICK_RATE + 0.5))
 
-float vibrato(float average_freq) {
+uint16_t vibrato(uint16_t average_period) {
+    uint16_t scale = pgm_read_word(&vibrato_period_lut[vibrato_counter >> 8]);
     #ifdef VIBRATO_STRENGTH_ENABLE
-        float vibrated_freq = average_freq * pow(vibrato_lut[(int)vibrato_counter], vibrato_strength);
-    #else
-        float vibrated_freq = average_freq * vibrato_lut[(int)vibrato_counter];
+        scale = 32768 + (((int32_t)scale - 32768) * vibrato_strength >> 8);
     #endif
-    vibrato_counter = mod((vibrato_counter + vibrato_rate * (1.0 + 440.0/average_freq)), VIBRATO_LUT_LENGTH);
-    return vibrated_freq;
+    uint32_t vibrated_period = ((uint32_t)average_period * scale) >> 15;
+
+    vibrato_counter += vibrato_rate + (((((uint32_t)vibrato_rate * average_period) >> 8) * VIBRATO_SCALE) >> 16);
+    while (vibrato_counter >= (VIBRATO_LUT_LENGTH << 8)) {
+        vibrato_counter -= VIBRATO_LUT_LENGTH << 8;
+    }
+    return vibrated_period > UINT16_MAX ? UINT16_MAX : vibrated_period;
 }
 
 #endif
 
-#ifdef CPIN_AUDIO
-ISR(TIMER3_AUDIO_vect)
+// ln(2) * 440 / 24 / AUDIO_TICK_RATE out of 1 << 32. Each glissando step is
+// 440 / f / 24 octaves, which multiplies the period by about 1 + period * this.
+#define GLISSANDO_SCALE ((uint32_t)(0.69314718 * 440 / 24 * 4294967296.0 / AUDIO_TICK_RATE + 0.5))
+
+static uint16_t glide(uint16_t current, uint16_t target) {
+    if (!glissando || current == 0) {
+        return target;
+    }
+    uint16_t step = ((((uint32_t)current * current) >> 16) * GLISSANDO_SCALE) >> 16;
+    if (step == 0) {
+        step = 1;
+    }
+    if (current > target) {
+        return current - target > step ? current - step : target;
+    } else {
+        return target - current > step ? current + step : target;
+    }
+}
+
+static uint16_t next_period(uint16_t average_period) {
+    #ifdef VIBRATO_ENABLE
+        if (vibrato_strength > 0) {
+            average_period = vibrato(average_period);
+        }
+    #endif
+
+    if (envelope_index < 65535) {
+        envelope_index++;
+    }
+
+    return voice_envelope(average_period);
+}
+
+// Sets the next period of the timer playing the notes. Returns false when
+// the song has ended and the timer should be stopped.
+static bool audio_update(volatile uint16_t *timer_period, volatile uint16_t *timer_duty_cycle)
 {
-    float freq;
+    uint16_t p;
 
     if (playing_note) {
         if (voices > 0) {
 
-            #ifdef BPIN_AUDIO
-            float freq_alt = 0;
+            #if defined(BPIN_AUDIO) && defined(CPIN_AUDIO)
                 if (voices > 1) {
-                    if (polyphony_rate == 0) {
-                        if (glissando) {
-                            if (frequency_alt != 0 && frequency_alt < frequencies[voices - 2] && frequency_alt < frequencies[voices - 2] * pow(2, -440/frequencies[voices - 2]/12/2)) {
-                                frequency_alt = frequency_alt * pow(2, 440/frequency_alt/12/2);
-                            } else if (frequency_alt != 0 && frequency_alt > frequencies[voices - 2] && frequency_alt > frequencies[voices - 2] * pow(2, 440/frequencies[voices - 2]/12/2)) {
-                                frequency_alt = frequency_alt * pow(2, -440/frequency_alt/12/2);
-                            } else {
-                                frequency_alt = frequencies[voices - 2];
-                            }
-                        } else {
-                            frequency_alt = frequencies[voices - 2];
-                        }
-
-                        #ifdef VIBRATO_ENABLE
-                            if (vibrato_strength > 0) {
-                                freq_alt = vibrato(frequency_alt);
-                            } else {
-                                freq_alt = frequency_alt;
-                            }
-                        #else
-                            freq_alt = frequency_alt;
-                        #endif
-                    }
-
-                    if (envelope_index < 65535) {
-                        envelope_index++;
-                    }
-
-                    freq_alt = voice_envelope(freq_alt);
-
-                    if (freq_alt < 30.517578125) {
-                        freq_alt = 30.52;
+                    uint16_t p_alt = UINT16_MAX;
+                    if (polyphony_ticks == 0) {
+                        period_alt = glide(period_alt, periods[voices - 2]);
+                        p_alt = period_alt;
                     }
+                    p_alt = next_period(p_alt);
 
-                    TIMER_1_PERIOD = (uint16_t)(((float)F_CPU) / (freq_alt * CPU_PRESCALER));
-                    TIMER_1_DUTY_CYCLE = (uint16_t)((((float)F_CPU) / (freq_alt * CPU_PRESCALER)) * note_timbre);
+                    TIMER_1_PERIOD = p_alt;
+                    TIMER_1_DUTY_CYCLE = timbre_duty_cycle(p_alt);
                 }
             #endif
 
-            if (polyphony_rate > 0) {
+            if (polyphony_ticks > 0) {
                 if (voices > 1) {
                     voice_place %= voices;
-                    if (place++ > (frequencies[voice_place] / polyphony_rate / CPU_PRESCALER)) {
+                    place += *timer_period;
+                    if (place > polyphony_ticks) {
                         voice_place = (voice_place + 1) % voices;
-                        place = 0.0;
+                        place = 0;
                     }
                 }
-
-                #ifdef VIBRATO_ENABLE
-                    if (vibrato_strength > 0) {
-                        freq = vibrato(frequencies[voice_place]);
-                    } else {
-                        freq = frequencies[voice_place];
-                    }
-                #else
-                    freq = frequencies[voice_place];
-                #endif
+                p = periods[voice_place];
             } else {
-                if (glissando) {
-                    if (frequency != 0 && frequency < frequencies[voices - 1] && frequency < frequencies[voices - 1] * pow(2, -440/frequencies[voices - 1]/12/2)) {
-                        frequency = frequency * pow(2, 440/frequency/12/2);
-                    } else if (frequency != 0 && frequency > frequencies[voices - 1] && frequency > frequencies[voices - 1] * pow(2, 440/frequencies[voices - 1]/12/2)) {
-                        frequency = frequency * pow(2, -440/frequency/12/2);
-                    } else {
-                        frequency = frequencies[voices - 1];
-                    }
-                } else {
-                    frequency = frequencies[voices - 1];
-                }
-
-                #ifdef VIBRATO_ENABLE
-                    if (vibrato_strength > 0) {
-                        freq = vibrato(frequency);
-                    } else {
-                        freq = frequency;
-                    }
-                #else
-                    freq = frequency;
-                #endif
-            }
-
-            if (envelope_index < 65535) {
-                envelope_index++;
+                period = glide(period, periods[voices - 1]);
+                p = period;
             }
 
-            freq = voice_envelope(freq);
-
-            if (freq < 30.517578125) {
-                freq = 30.52;
-            }
+            p = next_period(p);
 
-            TIMER_3_PERIOD = (uint16_t)(((float)F_CPU) / (freq * CPU_PRESCALER));
-            TIMER_3_DUTY_CYCLE = (uint16_t)((((float)F_CPU) / (freq * CPU_PRESCALER)) * note_timbre);
+            *timer_period = p;
+            *timer_duty_cycle = timbre_duty_cycle(p);
         }
     }
 
     if (playing_notes) {
-        if (note_frequency > 0) {
-            #ifdef VIBRATO_ENABLE
-                if (vibrato_strength > 0) {
-                    freq = vibrato(note_frequency);
-                } else {
-                    freq = note_frequency;
-                }
-            #else
-                    freq = note_frequency;
-            #endif
+        if (note_period > 0) {
+            p = next_period(note_period);
 
-            if (envelope_index < 65535) {
-                envelope_index++;
-            }
-            freq = voice_envelope(freq);
-
-            TIMER_3_PERIOD = (uint16_t)(((float)F_CPU) / (freq * CPU_PRESCALER));
-            TIMER_3_DUTY_CYCLE = (uint16_t)((((float)F_CPU) / (freq * CPU_PRESCALER)) * note_timbre);
+            *timer_period = p;
+            *timer_duty_cycle = timbre_duty_cycle(p);
         } else {
-            TIMER_3_PERIOD = 0;
-            TIMER_3_DUTY_CYCLE = 0;
+            *timer_period = REST_PERIOD;
+            *timer_duty_cycle = 0;
         }
 
-        note_position++;
-        bool end_of_note = false;
-        if (TIMER_3_PERIOD > 0) {
-            if (!note_resting) 
-                end_of_note = (note_position >= (note_length / TIMER_3_PERIOD * 0xFFFF - 1));
-            else
-                end_of_note = (note_position >= (note_length));
-        } else {
-            end_of_note = (note_position >= (note_length));
-        }
+        note_position += *timer_period;
 
-        if (end_of_note) {
+        if (note_position >= note_ticks) {
             current_note++;
             if (current_note >= notes_count) {
                 if (notes_repeat) {
                     current_note = 0;
                 } else {
-                    DISABLE_AUDIO_COUNTER_3_ISR;
-                    DISABLE_AUDIO_COUNTER_3_OUTPUT;
                     playing_notes = false;
-                    return;
+                    return false;
                 }
             }
             if (!note_resting) {
+                // a single period between notes, silent if the same note repeats
                 note_resting = true;
                 current_note--;
-                if ((*notes_pointer)[current_note][0] == (*notes_pointer)[current_note + 1][0]) {
-                    note_frequency = 0;
-                    note_length = 1;
-                } else {
-                    note_frequency = (*notes_pointer)[current_note][0];
-                    note_length = 1;
+                if (next_note_repeats()) {
+                    note_period = 0;
                 }
+                note_ticks = 1;
             } else {
                 note_resting = false;
                 envelope_index = 0;
-                note_frequency = (*notes_pointer)[current_note][0];
-                note_length = ((*notes_pointer)[current_note][1] / 4) * (((float)note_tempo) / 100);
+                load_note();
             }
 
             note_position = 0;
@@ -509,6 +535,16 @@ ISR(TIMER3_AUDIO_vect)
         playing_notes = false;
         playing_note = false;
     }
+    return true;
+}
+
+#ifdef CPIN_AUDIO
+ISR(TIMER3_AUDIO_vect)
+{
+    if (!audio_update(&TIMER_3_PERIOD, &TIMER_3_DUTY_CYCLE)) {
+        DISABLE_AUDIO_COUNTER_3_ISR;
+        DISABLE_AUDIO_COUNTER_3_OUTPUT;
+    }
 }
 #endif
 
@@ -516,140 +552,11 @@ ISR(TIMER3_AUDIO_vect)
 ISR(TIMER1_AUDIO_vect)
 {
     #if defined(BPIN_AUDIO) && !defined(CPIN_AUDIO)
-    float freq = 0;
-
-    if (playing_note) {
-        if (voices > 0) {
-            if (polyphony_rate > 0) {
-                if (voices > 1) {
-                    voice_place %= voices;
-                    if (place++ > (frequencies[voice_place] / polyphony_rate / CPU_PRESCALER)) {
-                        voice_place = (voice_place + 1) % voices;
-                        place = 0.0;
-                    }
-                }
-
-                #ifdef VIBRATO_ENABLE
-                    if (vibrato_strength > 0) {
-                        freq = vibrato(frequencies[voice_place]);
-                    } else {
-                        freq = frequencies[voice_place];
-                    }
-                #else
-                    freq = frequencies[voice_place];
-                #endif
-            } else {
-                if (glissando) {
-                    if (frequency != 0 && frequency < frequencies[voices - 1] && frequency < frequencies[voices - 1] * pow(2, -440/frequencies[voices - 1]/12/2)) {
-                        frequency = frequency * pow(2, 440/frequency/12/2);
-                    } else if (frequency != 0 && frequency > frequencies[voices - 1] && frequency > frequencies[voices - 1] * pow(2, 440/frequencies[voices - 1]/12/2)) {
-                        frequency = frequency * pow(2, -440/frequency/12/2);
-                    } else {
-                        frequency = frequencies[voices - 1];
-                    }
-                } else {
-                    frequency = frequencies[voices - 1];
-                }
-
-                #ifdef VIBRATO_ENABLE
-                    if (vibrato_strength > 0) {
-                        freq = vibrato(frequency);
-                    } else {
-                        freq = frequency;
-                    }
-                #else
-                    freq = frequency;
-                #endif
-            }
-
-            if (envelope_index < 65535) {
-                envelope_index++;
-            }
-
-            freq = voice_envelope(freq);
-
-            if (freq < 30.517578125) {
-                freq = 30.52;
-            }
-
-            TIMER_1_PERIOD = (uint16_t)(((float)F_CPU) / (freq * CPU_PRESCALER));
-            TIMER_1_DUTY_CYCLE = (uint16_t)((((float)F_CPU) / (freq * CPU_PRESCALER)) * note_timbre);
-        }
-    }
-
-    if (playing_notes) {
-        if (note_frequency > 0) {
-            #ifdef VIBRATO_ENABLE
-                if (vibrato_strength > 0) {
-                    freq = vibrato(note_frequency);
-                } else {
-                    freq = note_frequency;
-                }
-            #else
-                    freq = note_frequency;
-            #endif
-
-            if (envelope_index < 65535) {
-                envelope_index++;
-            }
-            freq = voice_envelope(freq);
-
-            TIMER_1_PERIOD = (uint16_t)(((float)F_CPU) / (freq * CPU_PRESCALER));
-            TIMER_1_DUTY_CYCLE = (uint16_t)((((float)F_CPU) / (freq * CPU_PRESCALER)) * note_timbre);
-        } else {
-            TIMER_1_PERIOD = 0;
-            TIMER_1_DUTY_CYCLE = 0;
-        }
-
-        note_position++;
-        bool end_of_note = false;
-        if (TIMER_1_PERIOD > 0) {
-            if (!note_resting) 
-                end_of_note = (note_position >= (note_length / TIMER_1_PERIOD * 0xFFFF - 1));
-            else
-                end_of_note = (note_position >= (note_length));
-        } else {
-            end_of_note = (note_position >= (note_length));
-        }
-
-        if (end_of_note) {
-            current_note++;
-            if (current_note >= notes_count) {
-                if (notes_repeat) {
-                    current_note = 0;
-                } else {
-                    DISABLE_AUDIO_COUNTER_1_ISR;
-                    DISABLE_AUDIO_COUNTER_1_OUTPUT;
-                    playing_notes = false;
-                    return;
-                }
-            }
-            if (!note_resting) {
-                note_resting = true;
-                current_note--;
-                if ((*notes_pointer)[current_note][0] == (*notes_pointer)[current_note + 1][0]) {
-                    note_frequency = 0;
-                    note_length = 1;
-                } else {
-                    note_frequency = (*notes_pointer)[current_note][0];
-                    note_length = 1;
-                }
-            } else {
-                note_resting = false;
-                envelope_index = 0;
-                note_frequency = (*notes_pointer)[current_note][0];
-                note_length = ((*notes_pointer)[current_note][1] / 4) * (((float)note_tempo) / 100);
-            }
-
-            note_position = 0;
-        }
-    }
-
-    if (!audio_config.enable) {
-        playing_notes = false;
-        playing_note = false;
+    if (!audio_update(&TIMER_1_PERIOD, &TIMER_1_DUTY_CYCLE)) {
+        DISABLE_AUDIO_COUNTER_1_ISR;
+        DISABLE_AUDIO_COUNTER_1_OUTPUT;
     }
-#endif
+    #endif
 }
 #endif
 
@@ -678,7 +585,7 @@ void play_note(float freq, int vol) {
         envelope_index = 0;
 
         if (freq > 0) {
-            frequencies[voices] = freq;
+            periods[voices] = frequency_to_period(freq);
             volumes[voices] = vol;
             voices++;
         }
@@ -702,7 +609,7 @@ void play_note(float freq, int vol) {
 
 }
 
-void play_notes(float (*np)[][2], uint16_t n_count, bool n_repeat)
+static void start_notes(float (*np)[][2], const compact_note_t *cnp, uint16_t n_count, bool n_repeat)
 {
 
     if (!audio_initialized) {
@@ -725,14 +632,14 @@ void play_notes(float (*np)[][2], uint16_t n_count, bool n_repeat)
         playing_notes = true;
 
         notes_pointer = np;
+        compact_notes_pointer = cnp;
         notes_count = n_count;
         notes_repeat = n_repeat;
 
         place = 0;
         current_note = 0;
 
-        note_frequency = (*notes_pointer)[current_note][0];
-        note_length = ((*notes_pointer)[current_note][1] / 4) * (((float)note_tempo) / 100);
+        load_note();
         note_position = 0;
 
 
@@ -750,6 +657,17 @@ void play_notes(float (*np)[][2], uint16_t n_count, bool n_repeat)
 
 }
 
+void play_notes(float (*np)[][2], uint16_t n_count, bool n_repeat)
+{
+    start_notes(np, NULL, n_count, n_repeat);
+}
+
+// Streams the song from flash, a note at a time
+void play_compact_notes(const compact_note_t *np, uint16_t n_count, bool n_repeat)
+{
+    start_notes(NULL, np, n_count, n_repeat);
+}
+
 bool is_playing_notes(void) {
     return playing_notes;
 }
@@ -785,7 +703,7 @@ void audio_off(void) {
 // Vibrato rate functions
 
 void set_vibrato_rate(float rate) {
-    vibrato_rate = rate;
+    vibrato_rate = rate * 256;
 }
 
 void increase_vibrato_rate(float change) {
@@ -799,7 +717,7 @@ void decrease_vibrato_rate(float change) {
 #ifdef VIBRATO_STRENGTH_ENABLE
 
 void set_vibrato_strength(float strength) {
-    vibrato_strength = strength;
+    vibrato_strength = strength * 256;
 }
 
 void increase_vibrato_strength(float change) {
@@ -816,30 +734,40 @@ void decrease_vibrato_strength(float change) {
 
 // Polyphony functions
 
+static void update_polyphony_ticks(void) {
+    // each voice plays for 1 / (CPU_PRESCALER * polyphony_rate) seconds
+    polyphony_ticks = polyphony_rate > 0 ? AUDIO_TICK_RATE / (CPU_PRESCALER * polyphony_rate) : 0;
+}
+
 void set_polyphony_rate(float rate) {
     polyphony_rate = rate;
+    update_polyphony_ticks();
 }
 
 void enable_polyphony() {
     polyphony_rate = 5;
+    update_polyphony_ticks();
 }
 
 void disable_polyphony() {
     polyphony_rate = 0;
+    update_polyphony_ticks();
 }
 
 void increase_polyphony_rate(float change) {
     polyphony_rate *= change;
+    update_polyphony_ticks();
 }
 
 void decrease_polyphony_rate(float change) {
     polyphony_rate /= change;
+    update_polyphony_ticks();
 }
 
 // Timbre function
 
 void set_timbre(float timbre) {
-    note_timbre = timbre;
+    note_timbre = TIMBRE_DUTY(timbre > 1 ? 1 : timbre);
 }
 
 // Tempo functions
@@ -44,6 +44,12 @@ typedef union {
     };
 } audio_config_t;
 
+// A note of a song stored in flash, see AUDIO_COMPACT_SONGS in musical_notes.h
+typedef struct {
+    uint8_t note;     // MIDI note number, 0 for a rest
+    uint8_t duration; // same units as MUSICAL_NOTE, 64 for a whole note
+} compact_note_t;
+
 bool is_audio_on(void);
 void audio_toggle(void);
 void audio_on(void);
@@ -90,6 +96,7 @@ void play_note(float freq, int vol);
 void stop_note(float freq);
 void stop_all_notes(void);
 void play_notes(float (*np)[][2], uint16_t n_count, bool n_repeat);
+void play_compact_notes(const compact_note_t *np, uint16_t n_count, bool n_repeat);
 
 #define SCALE (int8_t []){ 0 + (12*0), 2 + (12*0), 4 + (12*0), 5 + (12*0), 7 + (12*0), 9 + (12*0), 11 + (12*0), \
                            0 + (12*1), 2 + (12*1), 4 + (12*1), 5 + (12*1), 7 + (12*1), 9 + (12*1), 11 + (12*1), \
@@ -103,8 +110,13 @@ void play_notes(float (*np)[][2], uint16_t n_count, bool n_repeat);
 #define NOTE_ARRAY_SIZE(x) ((int16_t)(sizeof(x) / (sizeof(x[0]))))
 #define PLAY_NOTE_ARRAY(note_array, note_repeat, deprecated_arg) play_notes(&note_array, NOTE_ARRAY_SIZE((note_array)), (note_repeat)); \
 	_Pragma ("message \"'PLAY_NOTE_ARRAY' macro is deprecated\"")
+#ifdef AUDIO_COMPACT_SONGS
+#define PLAY_SONG(note_array) play_compact_notes(note_array, NOTE_ARRAY_SIZE((note_array)), false)
+#define PLAY_LOOP(note_array) play_compact_notes(note_array, NOTE_ARRAY_SIZE((note_array)), true)
+#else
 #define PLAY_SONG(note_array) play_notes(&note_array, NOTE_ARRAY_SIZE((note_array)), false)
 #define PLAY_LOOP(note_array) play_notes(&note_array, NOTE_ARRAY_SIZE((note_array)), true)
+#endif
 
 bool is_playing_notes(void);
 
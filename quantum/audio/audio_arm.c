@@ -14,6 +14,9 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+// The built-in songs below are kept in flash as compact notes
+#define AUDIO_COMPACT_SONGS
+
 #include "audio.h"
 #include "ch.h"
 #include "hal.h"
@@ -47,9 +50,10 @@ bool     playing_note = false;
 float    note_frequency = 0;
 float    note_length = 0;
 uint8_t  note_tempo = TEMPO_DEFAULT;
-float    note_timbre = TIMBRE_DEFAULT;
+uint8_t  note_timbre = TIMBRE_DUTY(TIMBRE_DEFAULT);
 uint16_t note_position = 0;
 float (* notes_pointer)[][2];
+const compact_note_t *compact_notes_pointer = NULL;
 uint16_t notes_count;
 bool     notes_repeat;
 bool     note_resting = false;
@@ -75,7 +79,23 @@ bool glissando = true;
 #ifndef STARTUP_SONG
     #define STARTUP_SONG SONG(STARTUP_SOUND)
 #endif
-float startup_song[][2] = STARTUP_SONG;
+const compact_note_t startup_song[] PROGMEM = STARTUP_SONG;
+
+static float note_frequency_at(uint8_t index)
+{
+    if (compact_notes_pointer) {
+        uint8_t note = pgm_read_byte(&compact_notes_pointer[index].note);
+        return note > 0 ? 440.0f * pow(2, (note - 69) / 12.0f) : 0;
+    }
+    return (*notes_pointer)[index][0];
+}
+
+static float note_length_at(uint8_t index)
+{
+    float duration = compact_notes_pointer ? pgm_read_byte(&compact_notes_pointer[index].duration)
+                                           : (*notes_pointer)[index][1];
+    return (duration / 4) * (((float)note_tempo) / 100);
+}
 
 static void gpt_cb8(GPTDriver *gptp);
 
@@ -425,6 +445,12 @@ float vibrato(float average_freq) {
 
 #endif
 
+// voices.c works on note periods, see AUDIO_TICK_RATE
+static float envelope_frequency(float freq) {
+    uint16_t period = freq * UINT16_MAX < AUDIO_TICK_RATE ? UINT16_MAX : AUDIO_TICK_RATE / freq;
+    return (float)AUDIO_TICK_RATE / voice_envelope(period);
+}
+
 static void gpt_cb8(GPTDriver *gptp) {
     float freq;
 
@@ -461,7 +487,7 @@ static void gpt_cb8(GPTDriver *gptp) {
                         envelope_index++;
                     }
 
-                    freq_alt = voice_envelope(freq_alt);
+                    freq_alt = envelope_frequency(freq_alt);
 
                     if (freq_alt < 30.517578125) {
                         freq_alt = 30.52;
@@ -519,7 +545,7 @@ static void gpt_cb8(GPTDriver *gptp) {
                 envelope_index++;
             }
 
-            freq = voice_envelope(freq);
+            freq = envelope_frequency(freq);
 
             if (freq < 30.517578125) {
                 freq = 30.52;
@@ -548,7 +574,7 @@ static void gpt_cb8(GPTDriver *gptp) {
             if (envelope_index < 65535) {
                 envelope_index++;
             }
-            freq = voice_envelope(freq);
+            freq = envelope_frequency(freq);
 
 
             if (GET_CHANNEL_1_FREQ != (uint16_t)freq) {
@@ -588,18 +614,18 @@ static void gpt_cb8(GPTDriver *gptp) {
             if (!note_resting) {
                 note_resting = true;
                 current_note--;
-                if ((*notes_pointer)[current_note][0] == (*notes_pointer)[current_note + 1][0]) {
+                if (note_frequency_at(current_note) == note_frequency_at(current_note + 1)) {
                     note_frequency = 0;
                     note_length = 1;
                 } else {
-                    note_frequency = (*notes_pointer)[current_note][0];
+                    note_frequency = note_frequency_at(current_note);
                     note_length = 1;
                 }
             } else {
                 note_resting = false;
                 envelope_index = 0;
-                note_frequency = (*notes_pointer)[current_note][0];
-                note_length = ((*notes_pointer)[current_note][1] / 4) * (((float)note_tempo) / 100);
+                note_frequency = note_frequency_at(current_note);
+                note_length = note_length_at(current_note);
             }
 
             note_position = 0;
@@ -644,7 +670,7 @@ void play_note(float freq, int vol) {
 
 }
 
-void play_notes(float (*np)[][2], uint16_t n_count, bool n_repeat)
+static void start_notes(float (*np)[][2], const compact_note_t *cnp, uint16_t n_count, bool n_repeat)
 {
 
     if (!audio_initialized) {
@@ -660,14 +686,15 @@ void play_notes(float (*np)[][2], uint16_t n_count, bool n_repeat)
         playing_notes = true;
 
         notes_pointer = np;
+        compact_notes_pointer = cnp;
         notes_count = n_count;
         notes_repeat = n_repeat;
 
         place = 0;
         current_note = 0;
 
-        note_frequency = (*notes_pointer)[current_note][0];
-        note_length = ((*notes_pointer)[current_note][1] / 4) * (((float)note_tempo) / 100);
+        note_frequency = note_frequency_at(current_note);
+        note_length = note_length_at(current_note);
         note_position = 0;
 
         gptStart(&GPTD8, &gpt8cfg1);
@@ -678,6 +705,16 @@ void play_notes(float (*np)[][2], uint16_t n_count, bool n_repeat)
 
 }
 
+void play_notes(float (*np)[][2], uint16_t n_count, bool n_repeat)
+{
+    start_notes(np, NULL, n_count, n_repeat);
+}
+
+void play_compact_notes(const compact_note_t *np, uint16_t n_count, bool n_repeat)
+{
+    start_notes(NULL, np, n_count, n_repeat);
+}
+
 bool is_playing_notes(void) {
     return playing_notes;
 }
@@ -763,7 +800,7 @@ void decrease_polyphony_rate(float change) {
 // Timbre function
 
 void set_timbre(float timbre) {
-    note_timbre = timbre;
+    note_timbre = TIMBRE_DUTY(timbre > 1 ? 1 : timbre);
 }
 
 // Tempo functions
@@ -22,6 +22,7 @@
     #include "ch.h"
     #include "hal.h"
 #endif
+#include "progmem.h"
 
 #ifndef LUTS_H
 #define LUTS_H
@@ -31,6 +32,8 @@
 #define FREQUENCY_LUT_LENGTH 349
 
 extern const float vibrato_lut[VIBRATO_LUT_LENGTH];
+// 1 / vibrato_lut, as a factor for note periods out of 32768
+extern const uint16_t vibrato_period_lut[VIBRATO_LUT_LENGTH] PROGMEM;
 extern const uint16_t frequency_lut[FREQUENCY_LUT_LENGTH];
 
 #endif /* LUTS_H */
@@ -25,7 +25,14 @@
 
 
 // Note Types
+// Translation units that define AUDIO_COMPACT_SONGS before including audio.h
+// get every SONG() as compact_note_t entries, meant to be kept in PROGMEM and
+// played with PLAY_SONG, instead of pairs of floats.
+#ifdef AUDIO_COMPACT_SONGS
+#define MUSICAL_NOTE(note, duration)   {MIDI_NOTE(NOTE##note), duration}
+#else
 #define MUSICAL_NOTE(note, duration)   {(NOTE##note), duration}
+#endif
 #define WHOLE_NOTE(note)               MUSICAL_NOTE(note, 64)
 #define HALF_NOTE(note)                MUSICAL_NOTE(note, 32)
 #define QUARTER_NOTE(note)             MUSICAL_NOTE(note, 16)
@@ -59,6 +66,20 @@
 #define TIMBRE_75       0.750f
 #define TIMBRE_DEFAULT  TIMBRE_50
 
+// Nearest MIDI note number to a frequency, as a constant expression so songs
+// can be converted at compile time. Anything below C0 (including rests) is 0.
+#define MIDI_OCTAVE(freq)  (((freq) >=   15.89f) + ((freq) >=   31.77f) + \
+                            ((freq) >=   63.54f) + ((freq) >=  127.09f) + \
+                            ((freq) >=  254.18f) + ((freq) >=  508.36f) + \
+                            ((freq) >= 1016.71f) + ((freq) >= 2033.42f) + \
+                            ((freq) >= 4066.84f) + ((freq) >= 8133.68f))
+#define MIDI_SEMITONE(freq) (((freq) >= 16.83f) + ((freq) >= 17.83f) + ((freq) >= 18.89f) + \
+                             ((freq) >= 20.02f) + ((freq) >= 21.21f) + ((freq) >= 22.47f) + \
+                             ((freq) >= 23.80f) + ((freq) >= 25.22f) + ((freq) >= 26.72f) + \
+                             ((freq) >= 28.31f) + ((freq) >= 29.99f))
+#define MIDI_NOTE(freq)    ((freq) < 15.89f ? 0 : 12 * MIDI_OCTAVE(freq) + \
+                            MIDI_SEMITONE((freq) * 2 / (1L << MIDI_OCTAVE(freq))))
+
 // Notes - # = Octave
 
 #define NOTE_REST         0.00f
@@ -19,8 +19,7 @@
 
 // these are imported from audio.c
 extern uint16_t envelope_index;
-extern float note_timbre;
-extern float polyphony_rate;
+extern uint8_t note_timbre;
 extern bool glissando;
 
 voice_type voice = default_voice;
@@ -37,119 +36,125 @@ void voice_deiterate() {
     voice = (voice - 1 + number_of_voices) % number_of_voices;
 }
 
-float voice_envelope(float frequency) {
-    // envelope_index ranges from 0 to 0xFFFF, which is preserved at 880.0 Hz
-    __attribute__ ((unused))
-    uint16_t compensated_index = (uint16_t)((float)envelope_index * (880.0 / frequency));
+#ifdef AUDIO_VOICES
 
+// envelope_index counts audio interrupts, which run once per period of the
+// note. Scaled by the period it becomes time, in steps of 1/880 s, which is
+// what envelope_index would be for a note at 880.0 Hz.
+#define COMPENSATION_SCALE ((uint32_t)(880.0 * (1UL << 24) / AUDIO_TICK_RATE + 0.5))
+
+static uint16_t compensated_index(uint16_t period) {
+    uint32_t ticks = ((uint32_t)envelope_index * period) >> 12;
+    if (ticks > UINT32_MAX / COMPENSATION_SCALE) {
+        return UINT16_MAX;
+    }
+    uint32_t index = (ticks * COMPENSATION_SCALE) >> 12;
+    return index > UINT16_MAX ? UINT16_MAX : index;
+}
+
+// Periods of the drum sounds for the given frequency range in Hz
+#define DRUM_PERIOD(low, high) (AUDIO_TICK_RATE / (high) + rand() % (AUDIO_TICK_RATE / (low) - AUDIO_TICK_RATE / (high)))
+
+static uint16_t slower(uint16_t period, uint8_t factor) {
+    uint32_t slowed = (uint32_t)period * factor;
+    return slowed > UINT16_MAX ? UINT16_MAX : slowed;
+}
+
+#endif
+
+uint16_t voice_envelope(uint16_t period) {
     switch (voice) {
         case default_voice:
             glissando = false;
-            note_timbre = TIMBRE_50;
-            polyphony_rate = 0;
+            note_timbre = TIMBRE_DUTY(TIMBRE_50);
 	        break;
 
     #ifdef AUDIO_VOICES
 
         case something:
             glissando = false;
-            polyphony_rate = 0;
-            switch (compensated_index) {
+            switch (compensated_index(period)) {
                 case 0 ... 9:
-                    note_timbre = TIMBRE_12;
+                    note_timbre = TIMBRE_DUTY(TIMBRE_12);
                     break;
 
                 case 10 ... 19:
-                    note_timbre = TIMBRE_25;
+                    note_timbre = TIMBRE_DUTY(TIMBRE_25);
                     break;
 
                 case 20 ... 200:
-                    note_timbre = .125 + .125;
+                    note_timbre = TIMBRE_DUTY(.125 + .125);
                     break;
 
                 default:
-                    note_timbre = .125;
+                    note_timbre = TIMBRE_DUTY(.125);
                     break;
             }
             break;
 
         case drums:
             glissando = false;
-            polyphony_rate = 0;
-                // switch (compensated_index) {
-                //     case 0 ... 10:
-                //         note_timbre = 0.5;
-                //         break;
-                //     case 11 ... 20:
-                //         note_timbre = 0.5 * (21 - compensated_index) / 10;
-                //         break;
-                //     default:
-                //         note_timbre = 0;
-                //         break;
-                // }
-                // frequency = (rand() % (int)(frequency * 1.2 - frequency)) + (frequency * 0.8);
-
-            if (frequency < 80.0) {
-
-            } else if (frequency < 160.0) {
+
+            if (period > AUDIO_TICK_RATE / 80) {
+
+            } else if (period > AUDIO_TICK_RATE / 160) {
 
                 // Bass drum: 60 - 100 Hz
-                frequency = (rand() % (int)(40)) + 60;
+                period = DRUM_PERIOD(60, 100);
                 switch (envelope_index) {
                     case 0 ... 10:
-                        note_timbre = 0.5;
+                        note_timbre = TIMBRE_DUTY(0.5);
                         break;
                     case 11 ... 20:
-                        note_timbre = 0.5 * (21 - envelope_index) / 10;
+                        note_timbre = TIMBRE_DUTY(0.5) * (21 - envelope_index) / 10;
                         break;
                     default:
                         note_timbre = 0;
                         break;
                 }
 
-            } else if (frequency < 320.0) {
-
+            } else if (period > AUDIO_TICK_RATE / 320) {
 
                 // Snare drum: 1 - 2 KHz
-                frequency = (rand() % (int)(1000)) + 1000;
+                period = DRUM_PERIOD(1000, 2000);
                 switch (envelope_index) {
                     case 0 ... 5:
-                        note_timbre = 0.5;
+                        note_timbre = TIMBRE_DUTY(0.5);
                         break;
                     case 6 ... 20:
-                        note_timbre = 0.5 * (21 - envelope_index) / 15;
+                        note_timbre = TIMBRE_DUTY(0.5) * (21 - envelope_index) / 15;
                         break;
                     default:
                         note_timbre = 0;
                         break;
                 }
 
-            } else if (frequency < 640.0) {
+            } else if (period > AUDIO_TICK_RATE / 640) {
 
                 // Closed Hi-hat: 3 - 5 KHz
-                frequency = (rand() % (int)(2000)) + 3000;
+                period = DRUM_PERIOD(3000, 5000);
                 switch (envelope_index) {
                     case 0 ... 15:
-                        note_timbre = 0.5;
+                        note_timbre = TIMBRE_DUTY(0.5);
                         break;
                     case 16 ... 20:
-                        note_timbre = 0.5 * (21 - envelope_index) / 5;
+                        note_timbre = TIMBRE_DUTY(0.5) * (21 - envelope_index) / 5;
                         break;
                     default:
                         note_timbre = 0;
                         break;
                 }
 
-            } else if (frequency < 1280.0) {
+            } else if (period > AUDIO_TICK_RATE / 1280) {
 
                 // Open Hi-hat: 3 - 5 KHz
-                frequency = (rand() % (int)(2000)) + 3000;
+                period = DRUM_PERIOD(3000, 5000);
                 switch (envelope_index) {
                     case 0 ... 35:
-                        note_timbre = 0.5;
+                        note_timbre = TIMBRE_DUTY(0.5);
                         break;
                     case 36 ... 50:
-                        note_timbre = 0.5 * (51 - envelope_index) / 15;
+                        note_timbre = TIMBRE_DUTY(0.5) * (51 - envelope_index) / 15;
                         break;
                     default:
                         note_timbre = 0;
@@ -160,131 +165,63 @@ float voice_envelope(float frequency) {
             break;
         case butts_fader:
             glissando = true;
-            polyphony_rate = 0;
-            switch (compensated_index) {
-                case 0 ... 9:
-                    frequency = frequency / 4;
-                    note_timbre = TIMBRE_12;
-	                break;
+            {
+                uint16_t index = compensated_index(period);
+                switch (index) {
+                    case 0 ... 9:
+                        period = slower(period, 4);
+                        note_timbre = TIMBRE_DUTY(TIMBRE_12);
+                        break;
 
-                case 10 ... 19:
-                    frequency = frequency / 2;
-                    note_timbre = TIMBRE_12;
-	                break;
+                    case 10 ... 19:
+                        period = slower(period, 2);
+                        note_timbre = TIMBRE_DUTY(TIMBRE_12);
+                        break;
 
-                case 20 ... 200:
-                    note_timbre = .125 - pow(((float)compensated_index - 20) / (200 - 20), 2)*.125;
-	                break;
+                    case 20 ... 200:
+                        // .125 - ((index - 20) / 180)^2 * .125, 180^2 / 32 is close to 1 << 10
+                        note_timbre = TIMBRE_DUTY(.125) - (((uint16_t)(index - 20) * (index - 20)) >> 10);
+                        break;
 
-                default:
-                    note_timbre = 0;
-                	break;
+                    default:
+                        note_timbre = 0;
+                        break;
+                }
             }
     	    break;
 
-        // case octave_crunch:
-        //     polyphony_rate = 0;
-        //     switch (compensated_index) {
-        //         case 0 ... 9:
-        //         case 20 ... 24:
-        //         case 30 ... 32:
-        //             frequency = frequency / 2;
-        //             note_timbre = TIMBRE_12;
-        //         break;
-
-        //         case 10 ... 19:
-        //         case 25 ... 29:
-        //         case 33 ... 35:
-        //             frequency = frequency * 2;
-        //             note_timbre = TIMBRE_12;
-	       //          break;
-
-        //         default:
-        //             note_timbre = TIMBRE_12;
-        //         	break;
-        //     }
-	       //  break;
-
         case duty_osc:
-            // This slows the loop down a substantial amount, so higher notes may freeze
             glissando = true;
-            polyphony_rate = 0;
-            switch (compensated_index) {
-                default:
-                    #define OCS_SPEED 10
-                    #define OCS_AMP   .25
-                    // sine wave is slow
-                    // note_timbre = (sin((float)compensated_index/10000*OCS_SPEED) * OCS_AMP / 2) + .5;
-                    // triangle wave is a bit faster
-                    note_timbre = (float)abs((compensated_index*OCS_SPEED % 3000) - 1500) * ( OCS_AMP / 1500 ) + (1 - OCS_AMP) / 2;
-                	break;
+            {
+                #define OCS_SPEED 10
+                #define OCS_AMP   .25
+                // triangle wave between (1 - OCS_AMP) / 2 and (1 + OCS_AMP) / 2
+                int16_t phase = (compensated_index(period) % (3000 / OCS_SPEED)) * OCS_SPEED - 1500;
+                note_timbre = TIMBRE_DUTY((1 - OCS_AMP) / 2) + (uint32_t)abs(phase) * TIMBRE_DUTY(OCS_AMP) / 1500;
             }
 	        break;
 
         case duty_octave_down:
             glissando = true;
-            polyphony_rate = 0;
-            note_timbre = (envelope_index % 2) * .125 + .375 * 2;
+            note_timbre = (envelope_index % 2) * TIMBRE_DUTY(.125) + TIMBRE_DUTY(.375 * 2);
             if ((envelope_index % 4) == 0)
-                note_timbre = 0.5;
+                note_timbre = TIMBRE_DUTY(0.5);
             if ((envelope_index % 8) == 0)
                 note_timbre = 0;
             break;
         case delayed_vibrato:
             glissando = true;
-            polyphony_rate = 0;
-            note_timbre = TIMBRE_50;
+            note_timbre = TIMBRE_DUTY(TIMBRE_50);
             #define VOICE_VIBRATO_DELAY 150
             #define VOICE_VIBRATO_SPEED 50
-            switch (compensated_index) {
-                case 0 ... VOICE_VIBRATO_DELAY:
-                    break;
-                default:
-                    frequency = frequency * vibrato_lut[(int)fmod((((float)compensated_index - (VOICE_VIBRATO_DELAY + 1))/1000*VOICE_VIBRATO_SPEED), VIBRATO_LUT_LENGTH)];
-                    break;
+            {
+                uint16_t index = compensated_index(period);
+                if (index > VOICE_VIBRATO_DELAY) {
+                    uint8_t step = ((index - (VOICE_VIBRATO_DELAY + 1)) / (1000 / VOICE_VIBRATO_SPEED)) % VIBRATO_LUT_LENGTH;
+                    period = ((uint32_t)period * pgm_read_word(&vibrato_period_lut[step])) >> 15;
+                }
             }
             break;
-        // case delayed_vibrato_octave:
-        //     polyphony_rate = 0;
-        //     if ((envelope_index % 2) == 1) {
-        //         note_timbre = 0.55;
-        //     } else {
-        //         note_timbre = 0.45;
-        //     }
-        //     #define VOICE_VIBRATO_DELAY 150
-        //     #define VOICE_VIBRATO_SPEED 50
-        //     switch (compensated_index) {
-        //         case 0 ... VOICE_VIBRATO_DELAY:
-        //             break;
-        //         default:
-        //             frequency = frequency * VIBRATO_LUT[(int)fmod((((float)compensated_index - (VOICE_VIBRATO_DELAY + 1))/1000*VOICE_VIBRATO_SPEED), VIBRATO_LUT_LENGTH)];
-        //             break;
-        //     }
-        //     break;
-        // case duty_fifth_down:
-        //     note_timbre = 0.5;
-        //     if ((envelope_index % 3) == 0)
-        //         note_timbre = 0.75;
-        //     break;
-        // case duty_fourth_down:
-        //     note_timbre = 0.0;
-        //     if ((envelope_index % 12) == 0)
-        //         note_timbre = 0.75;
-        //     if (((envelope_index % 12) % 4) != 1)
-        //         note_timbre = 0.75;
-        //     break;
-        // case duty_third_down:
-        //     note_timbre = 0.5;
-        //     if ((envelope_index % 5) == 0)
-        //         note_timbre = 0.75;
-        //     break;
-        // case duty_fifth_third_down:
-        //     note_timbre = 0.5;
-        //     if ((envelope_index % 5) == 0)
-        //         note_timbre = 0.75;
-        //     if ((envelope_index % 3) == 0)
-        //         note_timbre = 0.25;
-        //     break;
 
     #endif
 
@@ -292,5 +229,5 @@ float voice_envelope(float frequency) {
    			break;
     }
 
-    return frequency;
+    return period;
 }
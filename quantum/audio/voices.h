@@ -24,7 +24,21 @@
 #ifndef VOICES_H
 #define VOICES_H
 
-float voice_envelope(float frequency);
+// The voices run in the audio interrupts, so they work without floating
+// point: notes are given as their period in audio timer ticks, of which
+// there are AUDIO_TICK_RATE per second, and note_timbre is the duty cycle
+// out of 255.
+#ifndef AUDIO_TICK_RATE
+  #if defined(__AVR__)
+    #define AUDIO_TICK_RATE (F_CPU / 8)
+  #else
+    #define AUDIO_TICK_RATE 2000000UL
+  #endif
+#endif
+
+#define TIMBRE_DUTY(timbre) ((uint8_t)((timbre) * 255 + 0.5))
+
+uint16_t voice_envelope(uint16_t period);
 
 typedef enum {
     default_voice,
@@ -0,0 +1,80 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "deadline.h"
+#include "timer.h"
+
+/* true if time a comes before time b, across timer wraparound */
+#define DEADLINE_BEFORE(a, b) ((int16_t)((uint16_t)(a) - (uint16_t)(b)) < 0)
+
+typedef struct {
+    uint16_t time;
+    deadline_callback_t callback;
+} deadline_t;
+
+static deadline_t deadlines[DEADLINE_COUNT];
+static uint8_t deadline_armed = 0;
+static uint16_t deadline_earliest;
+
+static void deadline_update(void)
+{
+    bool found = false;
+
+    for (uint8_t id = 0; id < DEADLINE_COUNT; ++id) {
+        if ((deadline_armed & (1 << id)) &&
+            (!found || DEADLINE_BEFORE(deadlines[id].time, deadline_earliest))) {
+            deadline_earliest = deadlines[id].time;
+            found = true;
+        }
+    }
+}
+
+void deadline_set(deadline_id_t id, uint16_t time, deadline_callback_t callback)
+{
+    deadlines[id].time = time;
+    deadlines[id].callback = callback;
+    deadline_armed |= 1 << id;
+    deadline_update();
+}
+
+void deadline_cancel(deadline_id_t id)
+{
+    deadline_armed &= ~(1 << id);
+    deadline_update();
+}
+
+bool deadline_next(uint16_t *time)
+{
+    if (!deadline_armed) return false;
+    *time = deadline_earliest;
+    return true;
+}
+
+void deadline_task(void)
+{
+    if (!deadline_armed) return;
+
+    uint16_t now = timer_read();
+    if (DEADLINE_BEFORE(now, deadline_earliest)) return;
+
+    for (uint8_t id = 0; id < DEADLINE_COUNT; ++id) {
+        if ((deadline_armed & (1 << id)) && !DEADLINE_BEFORE(now, deadlines[id].time)) {
+            deadline_armed &= ~(1 << id);
+            deadlines[id].callback();
+        }
+    }
+    deadline_update();
+}
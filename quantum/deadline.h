@@ -0,0 +1,59 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEADLINE_H
+#define DEADLINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Features that need to run at a later time register a deadline here instead
+ * of polling their timers on every scan. matrix_scan_quantum() calls
+ * deadline_task(), which costs one timer comparison while nothing is due.
+ *
+ * Each feature owns one slot. Deadlines are one-shot, a callback that needs
+ * to run again sets its deadline again.
+ */
+typedef enum {
+#ifdef COMBO_ENABLE
+    DEADLINE_COMBO,
+#endif
+#ifdef TAP_DANCE_ENABLE
+    DEADLINE_TAP_DANCE,
+#endif
+#if defined(AUDIO_ENABLE) || (defined(MIDI_ENABLE) && defined(MIDI_BASIC))
+    DEADLINE_MUSIC,
+#endif
+#if !defined(DISABLE_LEADER) && defined(LEADER_SEQUENCE_COUNT) && LEADER_SEQUENCE_COUNT > 0
+    DEADLINE_LEADER,
+#endif
+    DEADLINE_COUNT  // at most 8
+} deadline_id_t;
+
+typedef void (*deadline_callback_t)(void);
+
+/* Calls callback from deadline_task() once timer_read() reaches time */
+void deadline_set(deadline_id_t id, uint16_t time, deadline_callback_t callback);
+void deadline_cancel(deadline_id_t id);
+
+/* Earliest pending deadline, false if there is none. Nothing but the matrix
+ * needs the main loop before that time.
+ */
+bool deadline_next(uint16_t *time);
+
+void deadline_task(void);
+
+#endif
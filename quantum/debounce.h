@@ -0,0 +1,46 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "matrix.h"
+
+/* Debounce time in milliseconds, 0 disables debouncing */
+#ifndef DEBOUNCING_DELAY
+#   define DEBOUNCING_DELAY 5
+#endif
+
+#if (DEBOUNCING_DELAY > 255)
+#   error "DEBOUNCING_DELAY must not be greater than 255"
+#endif
+
+/* Common interface of the debounce algorithms in quantum/debounce/. Exactly
+ * one of them is linked in, selected with DEBOUNCE_TYPE in rules.mk.
+ *
+ * raw:     the matrix as read from the hardware this scan
+ * cooked:  the debounced matrix, updated in place
+ * changed: true if raw differs from the previous scan
+ */
+void debounce_init(uint8_t num_rows);
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed);
+
+/* true while any key is still settling */
+bool debounce_active(void);
+
+#endif
@@ -0,0 +1,58 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEBOUNCE_COMMON_H
+#define DEBOUNCE_COMMON_H
+
+#include "debounce.h"
+#include "timer.h"
+
+/* Counter value of a key or row that is not debouncing */
+#define DEBOUNCE_IDLE 0
+
+#define DEBOUNCE_ROW_BIT(col) ((matrix_row_t)1 << (col))
+
+/* Milliseconds since the previous call, saturated to fit a counter. The
+ * reference point only moves forward when at least a millisecond has
+ * passed, so fast scan loops don't lose partial milliseconds.
+ */
+static inline uint8_t debounce_elapsed(uint16_t *last_time)
+{
+    uint16_t now = timer_read();
+    uint16_t elapsed = TIMER_DIFF_16(now, *last_time);
+    if (elapsed) {
+        *last_time = now;
+    }
+    return elapsed > 255 ? 255 : elapsed;
+}
+
+/* Counts a counter down by elapsed milliseconds, returns true when it
+ * reaches DEBOUNCE_IDLE on this call.
+ */
+static inline bool debounce_countdown(uint8_t *counter, uint8_t elapsed)
+{
+    if (*counter == DEBOUNCE_IDLE) {
+        return false;
+    }
+    if (*counter > elapsed) {
+        *counter -= elapsed;
+        return false;
+    }
+    *counter = DEBOUNCE_IDLE;
+    return true;
+}
+
+#endif
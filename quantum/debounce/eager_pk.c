@@ -0,0 +1,95 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Per-key eager: a change is reported on its first edge and the key is then
+ * locked for DEBOUNCING_DELAY milliseconds, during which further edges on
+ * that key are ignored. Presses reach the host without any added latency.
+ */
+
+#include "debounce_common.h"
+
+static uint8_t debounce_counters[MATRIX_ROWS * MATRIX_COLS];
+static uint16_t counters_active = 0;
+static uint16_t last_time;
+
+void debounce_init(uint8_t num_rows)
+{
+    for (uint16_t i = 0; i < MATRIX_ROWS * MATRIX_COLS; i++) {
+        debounce_counters[i] = DEBOUNCE_IDLE;
+    }
+    counters_active = 0;
+    last_time = timer_read();
+}
+
+#if (DEBOUNCING_DELAY > 0)
+static void update_debounce_counters(uint8_t num_rows)
+{
+    uint8_t elapsed = debounce_elapsed(&last_time);
+    uint8_t *counter = debounce_counters;
+
+    for (uint16_t i = 0; i < num_rows * MATRIX_COLS; i++, counter++) {
+        if (debounce_countdown(counter, elapsed)) {
+            counters_active--;
+        }
+    }
+}
+
+static void transfer_matrix_values(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows)
+{
+    uint8_t *counter = debounce_counters;
+
+    for (uint8_t row = 0; row < num_rows; row++) {
+        matrix_row_t delta = raw[row] ^ cooked[row];
+        for (uint8_t col = 0; col < MATRIX_COLS; col++, counter++) {
+            matrix_row_t col_mask = DEBOUNCE_ROW_BIT(col);
+            if ((delta & col_mask) && *counter == DEBOUNCE_IDLE) {
+                cooked[row] ^= col_mask;
+                *counter = DEBOUNCING_DELAY;
+                counters_active++;
+            }
+        }
+    }
+}
+#endif
+
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed)
+{
+#if (DEBOUNCING_DELAY > 0)
+    bool expired = false;
+    if (counters_active) {
+        uint16_t active = counters_active;
+        update_debounce_counters(num_rows);
+        expired = counters_active != active;
+    } else {
+        last_time = timer_read();
+    }
+    // A key that changed while it was locked is picked up once it unlocks
+    if (changed || expired) {
+        transfer_matrix_values(raw, cooked, num_rows);
+    }
+#else
+    if (changed) {
+        for (uint8_t i = 0; i < num_rows; i++) {
+            cooked[i] = raw[i];
+        }
+    }
+#endif
+}
+
+bool debounce_active(void)
+{
+    return counters_active;
+}
@@ -0,0 +1,93 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Per-key symmetric defer: a key that differs from its debounced state
+ * starts its own timer and only that key is updated once the timer runs
+ * out, so chatter on one switch no longer delays the rest of the matrix.
+ */
+
+#include "debounce_common.h"
+
+static uint8_t debounce_counters[MATRIX_ROWS * MATRIX_COLS];
+static uint16_t counters_active = 0;
+static uint16_t last_time;
+
+void debounce_init(uint8_t num_rows)
+{
+    for (uint16_t i = 0; i < MATRIX_ROWS * MATRIX_COLS; i++) {
+        debounce_counters[i] = DEBOUNCE_IDLE;
+    }
+    counters_active = 0;
+    last_time = timer_read();
+}
+
+#if (DEBOUNCING_DELAY > 0)
+static void update_debounce_counters(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows)
+{
+    uint8_t elapsed = debounce_elapsed(&last_time);
+    uint8_t *counter = debounce_counters;
+
+    for (uint8_t row = 0; row < num_rows; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++, counter++) {
+            if (debounce_countdown(counter, elapsed)) {
+                counters_active--;
+                matrix_row_t col_mask = DEBOUNCE_ROW_BIT(col);
+                cooked[row] = (cooked[row] & ~col_mask) | (raw[row] & col_mask);
+            }
+        }
+    }
+}
+
+static void start_debounce_counters(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows)
+{
+    uint8_t *counter = debounce_counters;
+
+    for (uint8_t row = 0; row < num_rows; row++) {
+        matrix_row_t delta = raw[row] ^ cooked[row];
+        for (uint8_t col = 0; col < MATRIX_COLS; col++, counter++) {
+            if ((delta & DEBOUNCE_ROW_BIT(col)) && *counter == DEBOUNCE_IDLE) {
+                *counter = DEBOUNCING_DELAY;
+                counters_active++;
+            }
+        }
+    }
+}
+#endif
+
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed)
+{
+#if (DEBOUNCING_DELAY > 0)
+    if (counters_active) {
+        update_debounce_counters(raw, cooked, num_rows);
+    } else {
+        last_time = timer_read();
+    }
+    if (changed) {
+        start_debounce_counters(raw, cooked, num_rows);
+    }
+#else
+    if (changed) {
+        for (uint8_t i = 0; i < num_rows; i++) {
+            cooked[i] = raw[i];
+        }
+    }
+#endif
+}
+
+bool debounce_active(void)
+{
+    return counters_active;
+}
@@ -0,0 +1,60 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEBOUNCE_TEST_COMMON_HPP_
+#define DEBOUNCE_TEST_COMMON_HPP_
+
+#include "gtest/gtest.h"
+extern "C" {
+#include "debounce.h"
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+class Debounce : public testing::Test {
+public:
+    Debounce() {
+        set_time(0);
+        for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+            raw[i] = 0;
+            cooked[i] = 0;
+        }
+        debounce_init(MATRIX_ROWS);
+    }
+
+    // Runs one scan with the current raw matrix, then advances the clock
+    void scan(bool changed, uint32_t ms = 1) {
+        debounce(raw, cooked, MATRIX_ROWS, changed);
+        advance_time(ms);
+    }
+
+    void set_key(uint8_t row, uint8_t col, bool pressed) {
+        if (pressed) {
+            raw[row] |= (matrix_row_t)1 << col;
+        } else {
+            raw[row] &= ~((matrix_row_t)1 << col);
+        }
+    }
+
+    bool is_on(uint8_t row, uint8_t col) {
+        return cooked[row] & ((matrix_row_t)1 << col);
+    }
+
+    matrix_row_t raw[MATRIX_ROWS];
+    matrix_row_t cooked[MATRIX_ROWS];
+};
+
+#endif /* DEBOUNCE_TEST_COMMON_HPP_ */
@@ -0,0 +1,57 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "debounce_test_common.hpp"
+
+TEST_F(Debounce, PressIsReportedImmediately) {
+    set_key(0, 1, true);
+    scan(true);
+    EXPECT_TRUE(is_on(0, 1));
+    EXPECT_TRUE(debounce_active());
+}
+
+TEST_F(Debounce, ChatterIsIgnoredDuringLockout) {
+    set_key(0, 1, true);
+    scan(true);
+    set_key(0, 1, false);
+    scan(true);
+    set_key(0, 1, true);
+    scan(true);
+    EXPECT_TRUE(is_on(0, 1));
+    scan(false, DEBOUNCING_DELAY);
+    scan(false);
+    EXPECT_TRUE(is_on(0, 1));
+    EXPECT_FALSE(debounce_active());
+}
+
+TEST_F(Debounce, OtherKeysAreNotLocked) {
+    set_key(0, 1, true);
+    scan(true);
+    set_key(0, 2, true);
+    scan(true);
+    EXPECT_TRUE(is_on(0, 2));
+}
+
+TEST_F(Debounce, ReleaseDuringLockoutIsReportedWhenItExpires) {
+    set_key(3, 9, true);
+    scan(true);
+    set_key(3, 9, false);
+    scan(true);
+    EXPECT_TRUE(is_on(3, 9));
+    scan(false, DEBOUNCING_DELAY);
+    scan(false);
+    EXPECT_FALSE(is_on(3, 9));
+}
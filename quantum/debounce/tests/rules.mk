@@ -0,0 +1,25 @@
+DEBOUNCE_COMMON_DEFS := -DMATRIX_ROWS=4 -DMATRIX_COLS=10 -DDEBOUNCING_DELAY=5
+
+debounce_sym_g_DEFS := $(DEBOUNCE_COMMON_DEFS)
+debounce_sym_g_SRC := \
+	$(QUANTUM_PATH)/debounce/tests/sym_g_tests.cpp \
+	$(QUANTUM_PATH)/debounce/sym_g.c \
+	$(TMK_PATH)/common/test/timer.c
+
+debounce_sym_pk_DEFS := $(DEBOUNCE_COMMON_DEFS)
+debounce_sym_pk_SRC := \
+	$(QUANTUM_PATH)/debounce/tests/sym_pk_tests.cpp \
+	$(QUANTUM_PATH)/debounce/sym_pk.c \
+	$(TMK_PATH)/common/test/timer.c
+
+debounce_eager_pk_DEFS := $(DEBOUNCE_COMMON_DEFS)
+debounce_eager_pk_SRC := \
+	$(QUANTUM_PATH)/debounce/tests/eager_pk_tests.cpp \
+	$(QUANTUM_PATH)/debounce/eager_pk.c \
+	$(TMK_PATH)/common/test/timer.c
+
+debounce_eager_pr_DEFS := $(DEBOUNCE_COMMON_DEFS)
+debounce_eager_pr_SRC := \
+	$(QUANTUM_PATH)/debounce/tests/eager_pr_tests.cpp \
+	$(QUANTUM_PATH)/debounce/eager_pr.c \
+	$(TMK_PATH)/common/test/timer.c
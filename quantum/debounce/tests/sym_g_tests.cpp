@@ -0,0 +1,43 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "debounce_test_common.hpp"
+
+TEST_F(Debounce, PressIsReportedAfterTheDelay) {
+    set_key(0, 1, true);
+    scan(true);
+    for (int i = 0; i < DEBOUNCING_DELAY; i++) {
+        EXPECT_FALSE(is_on(0, 1));
+        scan(false);
+    }
+    scan(false);
+    EXPECT_TRUE(is_on(0, 1));
+    EXPECT_FALSE(debounce_active());
+}
+
+TEST_F(Debounce, ChatterOnAnyKeyDelaysTheWholeMatrix) {
+    set_key(0, 1, true);
+    scan(true, 3);
+    set_key(2, 4, true);
+    scan(true, 3);
+    // The second change restarted the global timer
+    scan(false);
+    EXPECT_FALSE(is_on(0, 1));
+    scan(false, DEBOUNCING_DELAY);
+    scan(false);
+    EXPECT_TRUE(is_on(0, 1));
+    EXPECT_TRUE(is_on(2, 4));
+}
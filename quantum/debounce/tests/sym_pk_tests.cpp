@@ -0,0 +1,52 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "debounce_test_common.hpp"
+
+TEST_F(Debounce, PressIsReportedAfterTheDelay) {
+    set_key(0, 1, true);
+    scan(true);
+    for (int i = 0; i < DEBOUNCING_DELAY - 1; i++) {
+        EXPECT_FALSE(is_on(0, 1));
+        scan(false);
+    }
+    scan(false);
+    EXPECT_TRUE(is_on(0, 1));
+    EXPECT_FALSE(debounce_active());
+}
+
+TEST_F(Debounce, KeysAreDebouncedIndependently) {
+    set_key(0, 1, true);
+    scan(true, 3);
+    set_key(2, 4, true);
+    scan(true, 2);
+    scan(false);
+    EXPECT_TRUE(is_on(0, 1));
+    EXPECT_FALSE(is_on(2, 4));
+    scan(false, 3);
+    scan(false);
+    EXPECT_TRUE(is_on(2, 4));
+}
+
+TEST_F(Debounce, ShortGlitchIsFiltered) {
+    set_key(1, 0, true);
+    scan(true, 2);
+    set_key(1, 0, false);
+    scan(true, DEBOUNCING_DELAY);
+    scan(false);
+    EXPECT_FALSE(is_on(1, 0));
+    EXPECT_FALSE(debounce_active());
+}
@@ -25,18 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "util.h"
 #include "matrix.h"
 #include "timer.h"
-
-
-/* Set 0 if debouncing isn't needed */
-
-#ifndef DEBOUNCING_DELAY
-#   define DEBOUNCING_DELAY 5
-#endif
-
-#if (DEBOUNCING_DELAY > 0)
-    static uint16_t debouncing_time;
-    static bool debouncing = false;
-#endif
+#include "debounce.h"
 
 #if (MATRIX_COLS <= 8)
 #    define print_matrix_header()  print("\nr/c 01234567\n")
@@ -59,15 +48,44 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
     extern const matrix_row_t matrix_mask[];
 #endif
 
+#ifndef MATRIX_IO_DELAY
+#    define MATRIX_IO_DELAY 30
+#endif
+
 #if (DIODE_DIRECTION == ROW2COL) || (DIODE_DIRECTION == COL2ROW)
 static const uint8_t row_pins[MATRIX_ROWS] = MATRIX_ROW_PINS;
 static const uint8_t col_pins[MATRIX_COLS] = MATRIX_COL_PINS;
+
+// The pins that are read are grouped by port at init, so that each port
+// is only read once and the pins that keep their relative position are
+// moved into place with a single shift
+#if (DIODE_DIRECTION == COL2ROW)
+#    define READ_PIN_COUNT MATRIX_COLS
+typedef matrix_row_t pin_state_t;
+#elif (MATRIX_ROWS <= 8)
+#    define READ_PIN_COUNT MATRIX_ROWS
+typedef uint8_t pin_state_t;
+#elif (MATRIX_ROWS <= 16)
+#    define READ_PIN_COUNT MATRIX_ROWS
+typedef uint16_t pin_state_t;
+#else
+#    define READ_PIN_COUNT MATRIX_ROWS
+typedef uint32_t pin_state_t;
 #endif
 
-/* matrix state(1:on, 0:off) */
-static matrix_row_t matrix[MATRIX_ROWS];
+typedef struct {
+    uint8_t port;   // I/O address of the PINx register
+    uint8_t mask;   // pins of the port in this run
+    int8_t shift;   // from the port bit to the matrix bit
+} pin_run_t;
+
+static pin_run_t pin_runs[READ_PIN_COUNT];
+static uint8_t pin_run_count;
+#endif
 
-static matrix_row_t matrix_debouncing[MATRIX_ROWS];
+/* matrix state(1:on, 0:off) */
+static matrix_row_t raw_matrix[MATRIX_ROWS]; //raw values
+static matrix_row_t matrix[MATRIX_ROWS]; //debounced values
 
 
 #if (DIODE_DIRECTION == COL2ROW)
@@ -165,60 +183,32 @@ void matrix_init(void) {
 
     // initialize matrix state: all keys off
     for (uint8_t i=0; i < MATRIX_ROWS; i++) {
+        raw_matrix[i] = 0;
         matrix[i] = 0;
-        matrix_debouncing[i] = 0;
     }
 
+    debounce_init(MATRIX_ROWS);
+
     matrix_init_quantum();
 }
 
 uint8_t matrix_scan(void)
 {
+    bool changed = false;
 
 #if (DIODE_DIRECTION == COL2ROW)
-
     // Set row, read cols
     for (uint8_t current_row = 0; current_row < MATRIX_ROWS; current_row++) {
-#       if (DEBOUNCING_DELAY > 0)
-            bool matrix_changed = read_cols_on_row(matrix_debouncing, current_row);
-
-            if (matrix_changed) {
-                debouncing = true;
-                debouncing_time = timer_read();
-            }
-
-#       else
-            read_cols_on_row(matrix, current_row);
-#       endif
-
+        changed |= read_cols_on_row(raw_matrix, current_row);
     }
-
 #elif (DIODE_DIRECTION == ROW2COL)
-
     // Set col, read rows
     for (uint8_t current_col = 0; current_col < MATRIX_COLS; current_col++) {
-#       if (DEBOUNCING_DELAY > 0)
-            bool matrix_changed = read_rows_on_col(matrix_debouncing, current_col);
-            if (matrix_changed) {
-                debouncing = true;
-                debouncing_time = timer_read();
-            }
-#       else
-             read_rows_on_col(matrix, current_col);
-#       endif
-
+        changed |= read_rows_on_col(raw_matrix, current_col);
     }
-
 #endif
 
-#   if (DEBOUNCING_DELAY > 0)
-        if (debouncing && (timer_elapsed(debouncing_time) > DEBOUNCING_DELAY)) {
-            for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
-                matrix[i] = matrix_debouncing[i];
-            }
-            debouncing = false;
-        }
-#   endif
+    debounce(raw_matrix, matrix, MATRIX_ROWS, changed);
 
     matrix_scan_quantum();
     return 1;
@@ -226,9 +216,7 @@ uint8_t matrix_scan(void)
 
 bool matrix_is_modified(void)
 {
-#if (DEBOUNCING_DELAY > 0)
-    if (debouncing) return false;
-#endif
+    if (debounce_active()) return false;
     return true;
 }
 
@@ -272,6 +260,63 @@ uint8_t matrix_key_count(void)
 
 
 
+#if (DIODE_DIRECTION == ROW2COL) || (DIODE_DIRECTION == COL2ROW)
+
+static void init_pin_runs(const uint8_t pins[])
+{
+    pin_run_count = 0;
+    for (uint8_t i = 0; i < READ_PIN_COUNT; i++) {
+        uint8_t port = pins[i] >> 4;
+        uint8_t bit = pins[i] & 0xF;
+        int8_t shift = i - bit;
+
+        // Keep the runs of a port next to each other, and merge the pins
+        // that need the same shift
+        uint8_t run = 0;
+        while (run < pin_run_count && pin_runs[run].port != port) {
+            run++;
+        }
+        while (run < pin_run_count && pin_runs[run].port == port && pin_runs[run].shift != shift) {
+            run++;
+        }
+        if (run < pin_run_count && pin_runs[run].port == port) {
+            pin_runs[run].mask |= _BV(bit);
+            continue;
+        }
+        for (uint8_t j = pin_run_count; j > run; j--) {
+            pin_runs[j] = pin_runs[j - 1];
+        }
+        pin_runs[run].port = port;
+        pin_runs[run].mask = _BV(bit);
+        pin_runs[run].shift = shift;
+        pin_run_count++;
+    }
+}
+
+// Returns a bit for each pin that is pulled low
+static pin_state_t read_pins(void)
+{
+    pin_state_t state = 0;
+    uint8_t port = 0;
+    uint8_t port_state = 0;
+    for (uint8_t run = 0; run < pin_run_count; run++) {
+        if (run == 0 || pin_runs[run].port != port) {
+            port = pin_runs[run].port;
+            port_state = ~_SFR_IO8(port);
+        }
+        uint8_t bits = port_state & pin_runs[run].mask;
+        int8_t shift = pin_runs[run].shift;
+        if (shift >= 0) {
+            state |= (pin_state_t)bits << shift;
+        } else {
+            state |= bits >> -shift;
+        }
+    }
+    return state;
+}
+
+#endif
+
 #if (DIODE_DIRECTION == COL2ROW)
 
 static void init_cols(void)
@@ -281,6 +326,8 @@ static void init_cols(void)
         _SFR_IO8((pin >> 4) + 1) &= ~_BV(pin & 0xF); // IN
         _SFR_IO8((pin >> 4) + 2) |=  _BV(pin & 0xF); // HI
     }
+
+    init_pin_runs(col_pins);
 }
 
 static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
@@ -288,23 +335,12 @@ static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
     // Store last value of row prior to reading
     matrix_row_t last_row_value = current_matrix[current_row];
 
-    // Clear data in matrix row
-    current_matrix[current_row] = 0;
-
     // Select row and wait for row selecton to stabilize
     select_row(current_row);
-    wait_us(30);
-
-    // For each col...
-    for(uint8_t col_index = 0; col_index < MATRIX_COLS; col_index++) {
-
-        // Select the col pin to read (active low)
-        uint8_t pin = col_pins[col_index];
-        uint8_t pin_state = (_SFR_IO8(pin >> 4) & _BV(pin & 0xF));
+    wait_us(MATRIX_IO_DELAY);
 
-        // Populate the matrix row with the state of the col pin
-        current_matrix[current_row] |=  pin_state ? 0 : (ROW_SHIFTER << col_index);
-    }
+    // Read all the col pins (active low)
+    current_matrix[current_row] = read_pins();
 
     // Unselect row
     unselect_row(current_row);
@@ -344,6 +380,8 @@ static void init_rows(void)
         _SFR_IO8((pin >> 4) + 1) &= ~_BV(pin & 0xF); // IN
         _SFR_IO8((pin >> 4) + 2) |=  _BV(pin & 0xF); // HI
     }
+
+    init_pin_runs(row_pins);
 }
 
 static bool read_rows_on_col(matrix_row_t current_matrix[], uint8_t current_col)
@@ -352,25 +390,30 @@ static bool read_rows_on_col(matrix_row_t current_matrix[], uint8_t current_col)
 
     // Select col and wait for col selecton to stabilize
     select_col(current_col);
-    wait_us(30);
+    wait_us(MATRIX_IO_DELAY);
+
+    // Read all the row pins (active low)
+    pin_state_t row_state = read_pins();
+    pin_state_t row_bit = 1;
+    matrix_row_t col_bit = ROW_SHIFTER << current_col;
 
     // For each row...
-    for(uint8_t row_index = 0; row_index < MATRIX_ROWS; row_index++)
+    for(uint8_t row_index = 0; row_index < MATRIX_ROWS; row_index++, row_bit <<= 1)
     {
 
         // Store last value of row prior to reading
         matrix_row_t last_row_value = current_matrix[row_index];
 
         // Check row pin state
-        if ((_SFR_IO8(row_pins[row_index] >> 4) & _BV(row_pins[row_index] & 0xF)) == 0)
+        if (row_state & row_bit)
         {
             // Pin LO, set col bit
-            current_matrix[row_index] |= (ROW_SHIFTER << current_col);
+            current_matrix[row_index] |= col_bit;
         }
         else
         {
             // Pin HI, clear col bit
-            current_matrix[row_index] &= ~(ROW_SHIFTER << current_col);
+            current_matrix[row_index] &= ~col_bit;
         }
 
         // Determine if the matrix changed state
@@ -16,9 +16,20 @@
 
 #include "process_combo.h"
 #include "print.h"
+#include <string.h>
 
 
-#define COMBO_TIMER_ELAPSED -1
+#define COMBO_BYTES ((COMBO_COUNT + 7) / 8)
+#define COMBO_BUCKET(keycode) (((keycode) ^ ((keycode) >> 8)) & (COMBO_INDEX_BUCKETS - 1))
+
+#define COMBO_BIT_GET(map, i)   ((map)[(i) >> 3] & (1 << ((i) & 7)))
+#define COMBO_BIT_SET(map, i)   do{ (map)[(i) >> 3] |= (1 << ((i) & 7)); } while(0)
+#define COMBO_BIT_CLR(map, i)   do{ (map)[(i) >> 3] &= ~(1 << ((i) & 7)); } while(0)
+
+/* Visits the set bits of a combo bitmap, skipping empty bytes at once */
+#define COMBO_FOREACH(map, i) \
+    for (uint16_t i = 0; i < COMBO_COUNT; i = (map)[i >> 3] ? i + 1 : (i | 7) + 1) \
+        if (COMBO_BIT_GET(map, i))
 
 
 __attribute__ ((weak))
@@ -31,8 +42,40 @@ void process_combo_event(uint8_t combo_index, bool pressed) {
 
 }
 
+typedef struct {
+    uint16_t keycode;
+#ifdef COMBO_ALLOW_ACTION_KEYS
+    keyrecord_t record;
+#endif
+} combo_buffered_key_t;
+
+/* Index: for every keycode bucket, the combos that have a key in that bucket */
+static uint8_t combo_index[COMBO_INDEX_BUCKETS][COMBO_BYTES];
+static uint8_t combo_key_count[COMBO_COUNT];
+static bool combo_index_valid = false;
+
+/* Combo keys pressed while the combo is not resolved yet, in press order */
+static combo_buffered_key_t combo_buffer[COMBO_MAX_KEYS];
+static uint8_t combo_buffer_len = 0;
+static uint16_t combo_timer;
+
+/* Combos that contain every buffered key */
+static uint8_t combo_candidates[COMBO_BYTES];
+/* Resolved combos that still have keys down, and those of them that were sent */
+static uint8_t combo_held[COMBO_BYTES];
+static uint8_t combo_fired[COMBO_BYTES];
+
 static uint8_t current_combo_index = 0;
 
+// Do not treat the (weak) key_combos too strict.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Warray-bounds"
+static inline combo_t *get_combo(uint16_t index)
+{
+    return &key_combos[index];
+}
+#pragma GCC diagnostic pop
+
 static inline void send_combo(uint16_t action, bool pressed)
 {
     if (action) {
@@ -46,109 +89,236 @@ static inline void send_combo(uint16_t action, bool pressed)
     }
 }
 
-#define ALL_COMBO_KEYS_ARE_DOWN     (((1<<count)-1) == combo->state)
-#define NO_COMBO_KEYS_ARE_DOWN      (0 == combo->state)
-#define KEY_STATE_DOWN(key)         do{ combo->state |= (1<<key); } while(0)
-#define KEY_STATE_UP(key)           do{ combo->state &= ~(1<<key); } while(0)
-static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *record) 
+static int8_t combo_key_index(uint16_t index, uint16_t keycode)
 {
-    uint8_t count = 0;
-    uint8_t index = -1;
-    /* Find index of keycode and number of combo keys */
-    for (const uint16_t *keys = combo->keys; ;++count) {
-        uint16_t key = pgm_read_word(&keys[count]);
-        if (keycode == key) index = count;
-        if (COMBO_END == key) break;
+    const uint16_t *keys = get_combo(index)->keys;
+    for (uint8_t i = 0; ; ++i) {
+        uint16_t key = pgm_read_word(&keys[i]);
+        if (COMBO_END == key) return -1;
+        if (keycode == key) return i;
     }
+}
 
-    /* Return if not a combo key */
-    if (-1 == (int8_t)index) return false;
+static void combo_index_build(void)
+{
+    memset(combo_index, 0, sizeof(combo_index));
+    for (uint16_t i = 0; i < COMBO_COUNT; ++i) {
+        const uint16_t *keys = get_combo(i)->keys;
+        uint8_t count = 0;
+        for (uint16_t key; COMBO_END != (key = pgm_read_word(&keys[count])); ++count) {
+            COMBO_BIT_SET(combo_index[COMBO_BUCKET(key)], i);
+        }
+        combo_key_count[i] = count;
+        if (count > COMBO_MAX_KEYS) {
+            /* Too long to ever complete, leave it out of the index */
+            for (uint8_t b = 0; b < COMBO_INDEX_BUCKETS; ++b) {
+                COMBO_BIT_CLR(combo_index[b], i);
+            }
+        }
+    }
+    combo_index_valid = true;
+}
 
-    /* The combos timer is used to signal whether the combo is active */
-    bool is_combo_active = COMBO_TIMER_ELAPSED == combo->timer ? false : true;
+void combo_index_invalidate(void)
+{
+    combo_index_valid = false;
+}
 
-    if (record->event.pressed) {
-        KEY_STATE_DOWN(index);
-
-        if (is_combo_active) {
-            if (ALL_COMBO_KEYS_ARE_DOWN) { /* Combo was pressed */
-                send_combo(combo->keycode, true);
-                combo->timer = COMBO_TIMER_ELAPSED;
-            } else { /* Combo key was pressed */
-                combo->timer = timer_read();
-#ifdef COMBO_ALLOW_ACTION_KEYS
-                combo->prev_record = *record;
-#else
-                combo->prev_key = keycode;
-#endif
-            }
+/* out = the combos of from that contain keycode, returns whether there are any */
+static bool combo_filter(uint8_t *out, const uint8_t *from, uint16_t keycode)
+{
+    const uint8_t *bucket = combo_index[COMBO_BUCKET(keycode)];
+    bool any = false;
+
+    for (uint8_t b = 0; b < COMBO_BYTES; ++b) {
+        out[b] = from[b] & bucket[b];
+    }
+    COMBO_FOREACH(out, i) {
+        if (combo_key_index(i, keycode) < 0) {
+            COMBO_BIT_CLR(out, i);
+        } else {
+            any = true;
         }
-    } else {
-        if (ALL_COMBO_KEYS_ARE_DOWN) { /* Combo was released */
-            send_combo(combo->keycode, false);
+    }
+    return any;
+}
+
+/* Returns the first candidate whose keys are all down, or -1. longer is set if
+ * a candidate with more keys could still complete.
+ */
+static int16_t combo_find_complete(bool *longer)
+{
+    int16_t complete = -1;
+
+    *longer = false;
+    COMBO_FOREACH(combo_candidates, i) {
+        if (combo_key_count[i] == combo_buffer_len) {
+            if (complete < 0) complete = i;
+        } else {
+            *longer = true;
+        }
+    }
+    return complete;
+}
+
+static int8_t combo_buffer_find(uint16_t keycode)
+{
+    for (uint8_t i = 0; i < combo_buffer_len; ++i) {
+        if (combo_buffer[i].keycode == keycode) return i;
+    }
+    return -1;
+}
+
+/* The candidates are resolved: keep tracking their keys until they are released,
+ * so that they don't arm again while some of their keys are still down.
+ */
+static void combo_hold_candidates(void)
+{
+    COMBO_FOREACH(combo_candidates, i) {
+        combo_t *combo = get_combo(i);
+        combo->state = 0;
+        for (uint8_t k = 0; k < combo_buffer_len; ++k) {
+            combo->state |= (combo_state_t)1 << combo_key_index(i, combo_buffer[k].keycode);
         }
+        COMBO_BIT_SET(combo_held, i);
+    }
+    memset(combo_candidates, 0, sizeof(combo_candidates));
+    combo_buffer_len = 0;
+    deadline_cancel(DEADLINE_COMBO);
+}
 
-        if (is_combo_active) { /* Combo key was tapped */
+static void combo_fire(uint16_t index)
+{
+    combo_hold_candidates();
+    COMBO_BIT_SET(combo_fired, index);
+    current_combo_index = index;
+    send_combo(get_combo(index)->keycode, true);
+}
+
+/* No combo matched, send the buffered keys as if they were never held back */
+static void combo_flush(void)
+{
+    uint8_t len = combo_buffer_len;
+
+    combo_hold_candidates();
+    for (uint8_t i = 0; i < len; ++i) {
 #ifdef COMBO_ALLOW_ACTION_KEYS
-            record->event.pressed = true;
-            process_action(record, store_or_get_action(record->event.pressed, record->event.key));
-            record->event.pressed = false;
-            process_action(record, store_or_get_action(record->event.pressed, record->event.key));
+        keyrecord_t *record = &combo_buffer[i].record;
+        process_action(record, store_or_get_action(record->event.pressed, record->event.key));
 #else
-            register_code16(keycode);
-            send_keyboard_report();
-            unregister_code16(keycode);
+        register_code16(combo_buffer[i].keycode);
 #endif
-            combo->timer = 0;            
-        }
+    }
+}
+
+/* Sends the longest combo that is down, or the buffered keys if there is none.
+ * Returns whether a combo was sent.
+ */
+static bool combo_resolve(void)
+{
+    bool longer;
+    int16_t complete = combo_find_complete(&longer);
 
-        KEY_STATE_UP(index);        
+    if (complete >= 0) {
+        combo_fire(complete);
+        return true;
     }
+    combo_flush();
+    return false;
+}
 
-    if (NO_COMBO_KEYS_ARE_DOWN) {
-        combo->timer = 0;
+static bool combo_press(uint16_t keycode, keyrecord_t *record)
+{
+    uint8_t next[COMBO_BYTES];
+
+    if (combo_buffer_len && combo_buffer_find(keycode) < 0 &&
+        combo_filter(next, combo_candidates, keycode)) {
+        memcpy(combo_candidates, next, sizeof(combo_candidates));
+    } else {
+        /* The key ends all candidates, it is handled on its own below */
+        if (combo_buffer_len) combo_resolve();
+
+        for (uint8_t b = 0; b < COMBO_BYTES; ++b) {
+            next[b] = ~combo_held[b];
+        }
+        if (!combo_filter(combo_candidates, next, keycode)) {
+            return true;
+        }
     }
 
-    return is_combo_active;
+    combo_buffer[combo_buffer_len].keycode = keycode;
+#ifdef COMBO_ALLOW_ACTION_KEYS
+    combo_buffer[combo_buffer_len].record = *record;
+#endif
+    ++combo_buffer_len;
+    combo_timer = timer_read();
+    deadline_set(DEADLINE_COMBO, combo_timer + COMBO_TERM + 1, matrix_scan_combo);
+
+    bool longer;
+    int16_t complete = combo_find_complete(&longer);
+    if (complete >= 0 && !longer) {
+        combo_fire(complete);
+    }
+    return false;
 }
 
-bool process_combo(uint16_t keycode, keyrecord_t *record)
+/* Returns false if the release belongs to a combo that was sent */
+static bool combo_release(uint16_t keycode)
 {
-    bool is_combo_key = false;
+    bool pass = true;
 
-    for (current_combo_index = 0; current_combo_index < COMBO_COUNT; ++current_combo_index) {
-        combo_t *combo = &key_combos[current_combo_index];
-        is_combo_key |= process_single_combo(combo, keycode, record);
-    }    
+    COMBO_FOREACH(combo_held, i) {
+        int8_t key = combo_key_index(i, keycode);
+        if (key < 0) continue;
 
-    return !is_combo_key;
+        combo_t *combo = get_combo(i);
+        if (COMBO_BIT_GET(combo_fired, i)) {
+            /* The combo is released with the first of its keys */
+            if (combo->state == (combo_state_t)((combo_state_t)~0 >> (COMBO_MAX_KEYS - combo_key_count[i]))) {
+                current_combo_index = i;
+                send_combo(combo->keycode, false);
+            }
+            pass = false;
+        }
+        combo->state &= ~((combo_state_t)1 << key);
+        if (0 == combo->state) {
+            COMBO_BIT_CLR(combo_held, i);
+            COMBO_BIT_CLR(combo_fired, i);
+        }
+    }
+    return pass;
 }
 
-void matrix_scan_combo(void)
+bool process_combo(uint16_t keycode, keyrecord_t *record)
 {
-    for (int i = 0; i < COMBO_COUNT; ++i) {
-        // Do not treat the (weak) key_combos too strict.
-        #pragma GCC diagnostic push
-        #pragma GCC diagnostic ignored "-Warray-bounds"
-        combo_t *combo = &key_combos[i];
-        #pragma GCC diagnostic pop
-        if (combo->timer &&
-            combo->timer != COMBO_TIMER_ELAPSED && 
-            timer_elapsed(combo->timer) > COMBO_TERM) {
-            
-            /* This disables the combo, meaning key events for this
-             * combo will be handled by the next processors in the chain 
-             */
-            combo->timer = COMBO_TIMER_ELAPSED;
+    if (!combo_index_valid) {
+        if (combo_buffer_len) combo_flush();
+        combo_index_build();
+    }
+
+    if (record->event.pressed) {
+        return combo_press(keycode, record);
+    }
 
+    bool pass = true;
+    if (combo_buffer_find(keycode) >= 0 && !combo_resolve()) {
+        /* Combo key was tapped, its press was just sent so send the release too */
 #ifdef COMBO_ALLOW_ACTION_KEYS
-            process_action(&combo->prev_record, 
-                store_or_get_action(combo->prev_record.event.pressed, 
-                                    combo->prev_record.event.key));
+        process_action(record, store_or_get_action(record->event.pressed, record->event.key));
 #else
-            unregister_code16(combo->prev_key);
-            register_code16(combo->prev_key);
+        unregister_code16(keycode);
 #endif
-        }
+        pass = false;
+    }
+    return combo_release(keycode) && pass;
+}
+
+void matrix_scan_combo(void)
+{
+    if (combo_buffer_len && timer_elapsed(combo_timer) > COMBO_TERM) {
+        /* This resolves the combo, meaning key events for its keys
+         * will be handled by the next processors in the chain
+         */
+        combo_resolve();
     }
 }
@@ -20,24 +20,25 @@
 #include <stdint.h>
 #include "progmem.h"
 #include "quantum.h"
+#include "action_tapping.h"
 
-typedef struct
-{
-    const uint16_t *keys;
-    uint16_t keycode;        
 #ifdef EXTRA_EXTRA_LONG_COMBOS
-    uint32_t state;
+typedef uint32_t combo_state_t;
+#define COMBO_MAX_KEYS 32
 #elif EXTRA_LONG_COMBOS
-    uint16_t state;
+typedef uint16_t combo_state_t;
+#define COMBO_MAX_KEYS 16
 #else
-    uint8_t state;
-#endif
-    uint16_t timer;
-#ifdef COMBO_ALLOW_ACTION_KEYS
-    keyrecord_t prev_record;
-#else
-    uint16_t prev_key;
+typedef uint8_t combo_state_t;
+#define COMBO_MAX_KEYS 8
 #endif
+
+typedef struct
+{
+    const uint16_t *keys;
+    uint16_t keycode;
+    /* Keys of the combo that are held down while it is resolved */
+    combo_state_t state;
 } combo_t;
 
 
@@ -51,9 +52,18 @@ typedef struct
 #ifndef COMBO_TERM
 #define COMBO_TERM TAPPING_TERM
 #endif
+/* Number of hash buckets of the keycode to combo index, must be a power of two */
+#ifndef COMBO_INDEX_BUCKETS
+#define COMBO_INDEX_BUCKETS 16
+#endif
+
+#if (COMBO_INDEX_BUCKETS & (COMBO_INDEX_BUCKETS - 1)) != 0
+#error "COMBO_INDEX_BUCKETS must be a power of two"
+#endif
 
 bool process_combo(uint16_t keycode, keyrecord_t *record);
 void matrix_scan_combo(void);
 void process_combo_event(uint8_t combo_index, bool pressed);
+void combo_index_invalidate(void);
 
 #endif
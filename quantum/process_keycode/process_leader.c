@@ -16,6 +16,7 @@
 
 #ifndef DISABLE_LEADER
 
+#include <string.h>
 #include "process_leader.h"
 
 #ifndef LEADER_TIMEOUT
@@ -28,13 +29,72 @@ void leader_start(void) {}
 __attribute__ ((weak))
 void leader_end(void) {}
 
+__attribute__ ((weak))
+void process_leader_sequence(uint8_t index) {}
+
 // Leader key stuff
 bool leading = false;
 uint16_t leader_time = 0;
 
-uint16_t leader_sequence[5] = {0, 0, 0, 0, 0};
+uint16_t leader_sequence[LEADER_MAX_LENGTH] = {0};
 uint8_t leader_sequence_size = 0;
 
+bool is_leader_active(void) {
+  return leading;
+}
+
+#if LEADER_SEQUENCE_COUNT > 0
+#define NO_SEQUENCE 0xFF
+
+static void leader_sequence_done(uint8_t index) {
+  leading = false;
+  deadline_cancel(DEADLINE_LEADER);
+  leader_end();
+  if (index != NO_SEQUENCE) {
+    process_leader_sequence(index);
+  }
+}
+
+/* Walks the sequences that start with the keys typed so far. Returns the one
+ * that is exactly the keys typed, and whether a longer one is still possible.
+ */
+static uint8_t leader_sequence_match(bool *longer) {
+  uint8_t match = NO_SEQUENCE;
+  *longer = false;
+  for (uint8_t i = 0; i < LEADER_SEQUENCE_COUNT; i++) {
+    const uint16_t *keys = (const uint16_t *)pgm_read_ptr(&leader_sequences[i]);
+    uint8_t j = 0;
+    for (; j < leader_sequence_size; j++) {
+      // A KC_NO typed in the sequence equals LEADER_END, don't read past it
+      uint16_t key = pgm_read_word(&keys[j]);
+      if (key == LEADER_END || key != leader_sequence[j]) break;
+    }
+    if (j < leader_sequence_size) continue;
+    if (pgm_read_word(&keys[j]) == LEADER_END) {
+      match = i;
+    } else {
+      *longer = true;
+    }
+  }
+  return match;
+}
+
+static void leader_sequence_timeout(void) {
+  if (!leading) return;
+  bool longer;
+  leader_sequence_done(leader_sequence_match(&longer));
+}
+
+/* Ends the sequence as soon as the keys typed can't become another one */
+static void leader_sequence_key(void) {
+  bool longer;
+  uint8_t match = leader_sequence_match(&longer);
+  if (!longer || leader_sequence_size == LEADER_MAX_LENGTH) {
+    leader_sequence_done(match);
+  }
+}
+#endif
+
 bool process_leader(uint16_t keycode, keyrecord_t *record) {
   // Leader key set-up
   if (record->event.pressed) {
@@ -43,16 +103,20 @@ bool process_leader(uint16_t keycode, keyrecord_t *record) {
       leading = true;
       leader_time = timer_read();
       leader_sequence_size = 0;
-      leader_sequence[0] = 0;
-      leader_sequence[1] = 0;
-      leader_sequence[2] = 0;
-      leader_sequence[3] = 0;
-      leader_sequence[4] = 0;
+      memset(leader_sequence, 0, sizeof(leader_sequence));
+#if LEADER_SEQUENCE_COUNT > 0
+      deadline_set(DEADLINE_LEADER, leader_time + LEADER_TIMEOUT + 1, leader_sequence_timeout);
+#endif
       return false;
     }
     if (leading && timer_elapsed(leader_time) < LEADER_TIMEOUT) {
-      leader_sequence[leader_sequence_size] = keycode;
-      leader_sequence_size++;
+      if (leader_sequence_size < LEADER_MAX_LENGTH) {
+        leader_sequence[leader_sequence_size] = keycode;
+        leader_sequence_size++;
+#if LEADER_SEQUENCE_COUNT > 0
+        leader_sequence_key();
+#endif
+      }
       return false;
     }
   }
@@ -20,19 +20,43 @@
 #include "quantum.h"
 
 
+/* Keys after the leader that are remembered, later ones are ignored */
+#ifndef LEADER_MAX_LENGTH
+  #define LEADER_MAX_LENGTH 5
+#endif
+#if LEADER_MAX_LENGTH < 1 || LEADER_MAX_LENGTH > 255
+  #error "LEADER_MAX_LENGTH must be between 1 and 255"
+#endif
+
+/* Number of sequences in leader_sequences. With a table the sequences are
+ * matched as they are typed, and one fires as soon as no longer sequence
+ * starts with it, without waiting for LEADER_TIMEOUT.
+ */
+#define LEADER_END 0
+#ifndef LEADER_SEQUENCE_COUNT
+  #define LEADER_SEQUENCE_COUNT 0
+#endif
+
+#if LEADER_SEQUENCE_COUNT > 0
+/* LEADER_END terminated keycodes of each sequence, all in PROGMEM */
+extern const uint16_t * const leader_sequences[LEADER_SEQUENCE_COUNT] PROGMEM;
+#endif
+
 bool process_leader(uint16_t keycode, keyrecord_t *record);
 
 void leader_start(void);
 void leader_end(void);
+bool is_leader_active(void);
+void process_leader_sequence(uint8_t index);
 
 
-#define SEQ_ONE_KEY(key) if (leader_sequence[0] == (key) && leader_sequence[1] == 0 && leader_sequence[2] == 0 && leader_sequence[3] == 0 && leader_sequence[4] == 0)
-#define SEQ_TWO_KEYS(key1, key2) if (leader_sequence[0] == (key1) && leader_sequence[1] == (key2) && leader_sequence[2] == 0 && leader_sequence[3] == 0 && leader_sequence[4] == 0)
-#define SEQ_THREE_KEYS(key1, key2, key3) if (leader_sequence[0] == (key1) && leader_sequence[1] == (key2) && leader_sequence[2] == (key3) && leader_sequence[3] == 0 && leader_sequence[4] == 0)
-#define SEQ_FOUR_KEYS(key1, key2, key3, key4) if (leader_sequence[0] == (key1) && leader_sequence[1] == (key2) && leader_sequence[2] == (key3) && leader_sequence[3] == (key4) && leader_sequence[4] == 0)
-#define SEQ_FIVE_KEYS(key1, key2, key3, key4, key5) if (leader_sequence[0] == (key1) && leader_sequence[1] == (key2) && leader_sequence[2] == (key3) && leader_sequence[3] == (key4) && leader_sequence[4] == (key5))
+#define SEQ_ONE_KEY(key) if (leader_sequence_size == 1 && leader_sequence[0] == (key))
+#define SEQ_TWO_KEYS(key1, key2) if (leader_sequence_size == 2 && leader_sequence[0] == (key1) && leader_sequence[1] == (key2))
+#define SEQ_THREE_KEYS(key1, key2, key3) if (leader_sequence_size == 3 && leader_sequence[0] == (key1) && leader_sequence[1] == (key2) && leader_sequence[2] == (key3))
+#define SEQ_FOUR_KEYS(key1, key2, key3, key4) if (leader_sequence_size == 4 && leader_sequence[0] == (key1) && leader_sequence[1] == (key2) && leader_sequence[2] == (key3) && leader_sequence[3] == (key4))
+#define SEQ_FIVE_KEYS(key1, key2, key3, key4, key5) if (leader_sequence_size == 5 && leader_sequence[0] == (key1) && leader_sequence[1] == (key2) && leader_sequence[2] == (key3) && leader_sequence[3] == (key4) && leader_sequence[4] == (key5))
 
-#define LEADER_EXTERNS() extern bool leading; extern uint16_t leader_time; extern uint16_t leader_sequence[5]; extern uint8_t leader_sequence_size
+#define LEADER_EXTERNS() extern bool leading; extern uint16_t leader_time; extern uint16_t leader_sequence[LEADER_MAX_LENGTH]; extern uint8_t leader_sequence_size
 #define LEADER_DICTIONARY() if (leading && timer_elapsed(leader_time) > LEADER_TIMEOUT)
 
 #endif
@@ -13,6 +13,9 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+// Built-in songs are kept in flash as compact notes
+#define AUDIO_COMPACT_SONGS
+
 #include "process_music.h"
 
 #ifdef AUDIO_ENABLE
@@ -66,16 +69,16 @@ static uint16_t music_sequence_interval = 100;
   #ifndef MAJOR_SONG
     #define MAJOR_SONG SONG(MAJOR_SOUND)
   #endif
-  float music_mode_songs[NUMBER_OF_MODES][5][2] = {
+  const compact_note_t music_mode_songs[NUMBER_OF_MODES][5] PROGMEM = {
     CHROMATIC_SONG,
     GUITAR_SONG,
     VIOLIN_SONG,
     MAJOR_SONG
   };
-  float music_on_song[][2] = MUSIC_ON_SONG;
-  float music_off_song[][2] = MUSIC_OFF_SONG;
-  float midi_on_song[][2] = MIDI_ON_SONG;
-  float midi_off_song[][2] = MIDI_OFF_SONG;
+  const compact_note_t music_on_song[] PROGMEM = MUSIC_ON_SONG;
+  const compact_note_t music_off_song[] PROGMEM = MUSIC_OFF_SONG;
+  const compact_note_t midi_on_song[] PROGMEM = MIDI_ON_SONG;
+  const compact_note_t midi_off_song[] PROGMEM = MIDI_OFF_SONG;
 #endif
 
 static void music_noteon(uint8_t note) {
@@ -183,6 +186,7 @@ bool process_music(uint16_t keycode, keyrecord_t *record) {
           music_sequence_playing = true;
           music_sequence_position = 0;
           music_sequence_timer = 0;
+          deadline_set(DEADLINE_MUSIC, timer_read(), matrix_scan_music);
           return false;
         }
 
@@ -320,6 +324,7 @@ void matrix_scan_music(void) {
       music_noteon(next_note);
       music_sequence_position = (music_sequence_position + 1) % music_sequence_count;
     }
+    deadline_set(DEADLINE_MUSIC, music_sequence_timer + music_sequence_interval + 1, matrix_scan_music);
   }
 }
 
@@ -110,6 +110,34 @@ static inline void process_tap_dance_action_on_reset (qk_tap_dance_action_t *act
   send_keyboard_report();
 }
 
+static inline uint16_t tap_dance_term (qk_tap_dance_action_t *action)
+{
+  return action->custom_tapping_term > 0 ? action->custom_tapping_term : TAPPING_TERM;
+}
+
+/* Wakes matrix_scan_tap_dance() up when the next unfinished dance times out */
+static void tap_dance_schedule (void) {
+  bool pending = false;
+  uint16_t next = 0;
+
+  for (uint8_t i = 0; i <= highest_td; i++) {
+    qk_tap_dance_action_t *action = &tap_dance_actions[i];
+    if (action->state.count && !action->state.finished) {
+      uint16_t timeout = action->state.timer + tap_dance_term (action) + 1;
+      if (!pending || (int16_t)(timeout - next) < 0) {
+        next = timeout;
+        pending = true;
+      }
+    }
+  }
+
+  if (pending) {
+    deadline_set (DEADLINE_TAP_DANCE, next, matrix_scan_tap_dance);
+  } else {
+    deadline_cancel (DEADLINE_TAP_DANCE);
+  }
+}
+
 void preprocess_tap_dance(uint16_t keycode, keyrecord_t *record) {
   qk_tap_dance_action_t *action;
 
@@ -152,6 +180,7 @@ bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
       process_tap_dance_action_on_each_tap (action);
 
       last_td = keycode;
+      tap_dance_schedule ();
     } else {
       if (action->state.count && action->state.finished) {
         reset_tap_dance (&action->state);
@@ -169,21 +198,16 @@ bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
 void matrix_scan_tap_dance () {
   if (highest_td == -1)
     return;
-  uint16_t tap_user_defined;
 
   for (uint8_t i = 0; i <= highest_td; i++) {
     qk_tap_dance_action_t *action = &tap_dance_actions[i];
-    if(action->custom_tapping_term > 0 ) {
-      tap_user_defined = action->custom_tapping_term;
-    }
-    else{
-      tap_user_defined = TAPPING_TERM;
-    }
-    if (action->state.count && timer_elapsed (action->state.timer) > tap_user_defined) {
+    if (action->state.count && timer_elapsed (action->state.timer) > tap_dance_term (action)) {
       process_tap_dance_action_on_dance_finished (action);
       reset_tap_dance (&action->state);
     }
   }
+
+  tap_dance_schedule ();
 }
 
 void reset_tap_dance (qk_tap_dance_state_t *state) {
@@ -22,6 +22,7 @@
 extern const char keycode_to_ascii_lut[58];
 extern const char shifted_keycode_to_ascii_lut[58];
 extern const char terminal_prompt[8];
+extern bool terminal_enabled;
 bool process_terminal(uint16_t keycode, keyrecord_t *record);
 
 #endif
\ No newline at end of file
@@ -14,6 +14,9 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+// Built-in songs are kept in flash as compact notes
+#define AUDIO_COMPACT_SONGS
+
 #include "quantum.h"
 #ifdef PROTOCOL_LUFA
 #include "outputselect.h"
@@ -52,11 +55,11 @@ extern backlight_config_t backlight_config;
   #ifndef AG_SWAP_SONG
     #define AG_SWAP_SONG SONG(AG_SWAP_SOUND)
   #endif
-  float goodbye_song[][2] = GOODBYE_SONG;
-  float ag_norm_song[][2] = AG_NORM_SONG;
-  float ag_swap_song[][2] = AG_SWAP_SONG;
+  const compact_note_t goodbye_song[] PROGMEM = GOODBYE_SONG;
+  const compact_note_t ag_norm_song[] PROGMEM = AG_NORM_SONG;
+  const compact_note_t ag_swap_song[] PROGMEM = AG_SWAP_SONG;
   #ifdef DEFAULT_LAYER_SONGS
-    float default_layer_songs[][16][2] = DEFAULT_LAYER_SONGS;
+    const compact_note_t default_layer_songs[][16] PROGMEM = DEFAULT_LAYER_SONGS;
   #endif
 #endif
 
@@ -187,6 +190,120 @@ static uint16_t scs_timer[2] = {0, 0};
  */
 static bool grave_esc_was_shifted = false;
 
+#if ( defined(AUDIO_ENABLE) || (defined(MIDI_ENABLE) && defined(MIDI_BASIC))) && !defined(NO_MUSIC_MODE)
+static bool music_mode_active(void) {
+  return is_music_on() || is_midi_on();
+}
+#endif
+
+#ifdef UCIS_ENABLE
+static bool ucis_active(void) {
+  return qk_ucis_state.in_progress;
+}
+#endif
+
+#ifdef PRINTING_ENABLE
+static bool printer_active(void) {
+  return printing_enabled;
+}
+#endif
+
+#ifdef TERMINAL_ENABLE
+static bool terminal_active(void) {
+  return terminal_enabled;
+}
+#endif
+
+/* Keycode handlers run by process_record_quantum(), in this order. A handler
+ * is only called for keycodes in [min, max], or for any keycode while its
+ * active() hook returns true. Handlers that have to see every key cover the
+ * whole keycode space.
+ */
+#define PROCESS_ALL_KEYCODES 0x0000, 0xFFFF
+#define PROCESS_NO_KEYCODES  0xFFFF, 0x0000
+
+static const process_record_handler_t process_record_handlers[] PROGMEM = {
+  #if defined(AUDIO_ENABLE) && defined(AUDIO_CLICKY)
+    { PROCESS_ALL_KEYCODES, NULL, process_clicky },
+  #endif
+    { PROCESS_ALL_KEYCODES, NULL, process_record_kb },
+  #if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_KEYPRESSES)
+    { PROCESS_ALL_KEYCODES, NULL, process_rgb_matrix },
+  #endif
+  #if defined(MIDI_ENABLE) && defined(MIDI_ADVANCED)
+    { MIDI_TONE_MIN, MI_BENDU, NULL, process_midi },
+  #endif
+  #ifdef AUDIO_ENABLE
+    { AU_ON, MUV_DE, NULL, process_audio },
+  #endif
+  #ifdef STENO_ENABLE
+    { QK_STENO, QK_STENO_MAX, NULL, process_steno },
+  #endif
+  #if ( defined(AUDIO_ENABLE) || (defined(MIDI_ENABLE) && defined(MIDI_BASIC))) && !defined(NO_MUSIC_MODE)
+    { MU_ON, MI_TOG, music_mode_active, process_music },
+  #endif
+  #ifdef TAP_DANCE_ENABLE
+    { QK_TAP_DANCE, QK_TAP_DANCE_MAX, NULL, process_tap_dance },
+  #endif
+  #ifndef DISABLE_LEADER
+    { KC_LEAD, KC_LEAD, is_leader_active, process_leader },
+  #endif
+  #ifndef DISABLE_CHORDING
+    { QK_CHORDING, QK_CHORDING_MAX, NULL, process_chording },
+  #endif
+  #ifdef COMBO_ENABLE
+    { PROCESS_ALL_KEYCODES, NULL, process_combo },
+  #endif
+  #ifdef UNICODE_ENABLE
+    { QK_UNICODE, QK_UNICODE_MAX, NULL, process_unicode },
+  #endif
+  #ifdef UCIS_ENABLE
+    { PROCESS_NO_KEYCODES, ucis_active, process_ucis },
+  #endif
+  #ifdef PRINTING_ENABLE
+    { PRINT_ON, PRINT_OFF, printer_active, process_printer },
+  #endif
+  #ifdef AUTO_SHIFT_ENABLE
+    { PROCESS_ALL_KEYCODES, NULL, process_auto_shift },
+  #endif
+  #ifdef UNICODEMAP_ENABLE
+    { QK_UNICODE_MAP, 0xFFFF, NULL, process_unicode_map },
+  #endif
+  #ifdef TERMINAL_ENABLE
+    { TERM_ON, TERM_ON, terminal_active, process_terminal },
+  #endif
+};
+
+#define PROCESS_RECORD_HANDLER_COUNT (sizeof(process_record_handlers) / sizeof(process_record_handlers[0]))
+
+#ifdef PROCESS_RECORD_STATS
+uint32_t process_record_handler_calls = 0;
+const uint8_t process_record_handler_count = PROCESS_RECORD_HANDLER_COUNT;
+#endif
+
+/* Runs the handlers that apply to keycode, stopping at the first one that
+ * returns false.
+ */
+bool process_record_handlers_dispatch(uint16_t keycode, keyrecord_t *record) {
+  for (uint8_t i = 0; i < PROCESS_RECORD_HANDLER_COUNT; i++) {
+    const process_record_handler_t *handler = &process_record_handlers[i];
+    if (keycode < pgm_read_word(&handler->min) || keycode > pgm_read_word(&handler->max)) {
+      bool (*active)(void) = pgm_read_ptr(&handler->active);
+      if (!active || !active()) {
+        continue;
+      }
+    }
+    bool (*process)(uint16_t, keyrecord_t *) = pgm_read_ptr(&handler->process);
+#ifdef PROCESS_RECORD_STATS
+    process_record_handler_calls++;
+#endif
+    if (!process(keycode, record)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool process_record_quantum(keyrecord_t *record) {
 
   /* This gets the keycode from the key pressed */
@@ -221,61 +338,14 @@ bool process_record_quantum(keyrecord_t *record) {
     preprocess_tap_dance(keycode, record);
   #endif
 
-  if (!(
   #if defined(KEY_LOCK_ENABLE)
     // Must run first to be able to mask key_up events.
-    process_key_lock(&keycode, record) &&
-  #endif
-  #if defined(AUDIO_ENABLE) && defined(AUDIO_CLICKY)
-      process_clicky(keycode, record) &&
-  #endif //AUDIO_CLICKY
-    process_record_kb(keycode, record) &&
-  #if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_KEYPRESSES)
-    process_rgb_matrix(keycode, record) &&
-  #endif
-  #if defined(MIDI_ENABLE) && defined(MIDI_ADVANCED)
-    process_midi(keycode, record) &&
-  #endif
-  #ifdef AUDIO_ENABLE
-    process_audio(keycode, record) &&
-  #endif
-  #ifdef STENO_ENABLE
-    process_steno(keycode, record) &&
-  #endif
-  #if ( defined(AUDIO_ENABLE) || (defined(MIDI_ENABLE) && defined(MIDI_BASIC))) && !defined(NO_MUSIC_MODE)
-    process_music(keycode, record) &&
-  #endif
-  #ifdef TAP_DANCE_ENABLE
-    process_tap_dance(keycode, record) &&
-  #endif
-  #ifndef DISABLE_LEADER
-    process_leader(keycode, record) &&
-  #endif
-  #ifndef DISABLE_CHORDING
-    process_chording(keycode, record) &&
-  #endif
-  #ifdef COMBO_ENABLE
-    process_combo(keycode, record) &&
-  #endif
-  #ifdef UNICODE_ENABLE
-    process_unicode(keycode, record) &&
-  #endif
-  #ifdef UCIS_ENABLE
-    process_ucis(keycode, record) &&
-  #endif
-  #ifdef PRINTING_ENABLE
-    process_printer(keycode, record) &&
-  #endif
-  #ifdef AUTO_SHIFT_ENABLE
-    process_auto_shift(keycode, record) &&
-  #endif
-  #ifdef UNICODEMAP_ENABLE
-    process_unicode_map(keycode, record) &&
-  #endif
-  #ifdef TERMINAL_ENABLE
-    process_terminal(keycode, record) &&
+    if (!process_key_lock(&keycode, record)) {
+      return false;
+    }
   #endif
-      true)) {
+
+  if (!process_record_handlers_dispatch(keycode, record)) {
     return false;
   }
 
@@ -720,6 +790,9 @@ void send_string_P(const char *str) {
 }
 
 void send_string_with_delay(const char *str, uint8_t interval) {
+#ifdef SEND_STRING_QUEUE_ENABLE
+    send_string_enqueue(str, interval);
+#else
     while (1) {
         char ascii_code = *str;
         if (!ascii_code) break;
@@ -743,9 +816,13 @@ void send_string_with_delay(const char *str, uint8_t interval) {
         // interval
         { uint8_t ms = interval; while (ms--) wait_ms(1); }
     }
+#endif
 }
 
 void send_string_with_delay_P(const char *str, uint8_t interval) {
+#ifdef SEND_STRING_QUEUE_ENABLE
+    send_string_enqueue_P(str, interval);
+#else
     while (1) {
         char ascii_code = pgm_read_byte(str);
         if (!ascii_code) break;
@@ -769,9 +846,14 @@ void send_string_with_delay_P(const char *str, uint8_t interval) {
         // interval
         { uint8_t ms = interval; while (ms--) wait_ms(1); }
     }
+#endif
 }
 
 void send_char(char ascii_code) {
+#ifdef SEND_STRING_QUEUE_ENABLE
+  char str[2] = {ascii_code, 0};
+  send_string_enqueue(str, 0);
+#else
   uint8_t keycode;
   keycode = pgm_read_byte(&ascii_to_keycode_lut[(uint8_t)ascii_code]);
   if (pgm_read_byte(&ascii_to_shift_lut[(uint8_t)ascii_code])) {
@@ -783,6 +865,7 @@ void send_char(char ascii_code) {
       register_code(keycode);
       unregister_code(keycode);
   }
+#endif
 }
 
 void set_single_persistent_default_layer(uint8_t default_layer) {
@@ -854,24 +937,9 @@ void matrix_init_quantum() {
   matrix_init_kb();
 }
 
-uint8_t rgb_matrix_task_counter = 0;
-
-#ifndef RGB_MATRIX_SKIP_FRAMES
-  #define RGB_MATRIX_SKIP_FRAMES 1
-#endif
-
 void matrix_scan_quantum() {
-  #if defined(AUDIO_ENABLE)
-    matrix_scan_music();
-  #endif
-
-  #ifdef TAP_DANCE_ENABLE
-    matrix_scan_tap_dance();
-  #endif
-
-  #ifdef COMBO_ENABLE
-    matrix_scan_combo();
-  #endif
+  // music, tap dance, combo and leader timeouts are scheduled as deadlines
+  deadline_task();
 
   #if defined(BACKLIGHT_ENABLE) && defined(BACKLIGHT_PIN)
     backlight_task();
@@ -879,10 +947,10 @@ void matrix_scan_quantum() {
 
   #ifdef RGB_MATRIX_ENABLE
     rgb_matrix_task();
-    if (rgb_matrix_task_counter == 0) {
-      rgb_matrix_update_pwm_buffers();
-    }
-    rgb_matrix_task_counter = ((rgb_matrix_task_counter + 1) % (RGB_MATRIX_SKIP_FRAMES + 1));
+  #endif
+
+  #ifdef SEND_STRING_QUEUE_ENABLE
+    send_string_task();
   #endif
 
   matrix_scan_kb();
@@ -41,6 +41,7 @@
 #include <stddef.h>
 #include "bootloader.h"
 #include "timer.h"
+#include "deadline.h"
 #include "config_common.h"
 #include "led.h"
 #include "action_util.h"
@@ -48,6 +49,10 @@
 #include "print.h"
 #include "send_string_keycodes.h"
 
+#ifdef SEND_STRING_QUEUE_ENABLE
+	#include "send_string_queue.h"
+#endif
+
 extern uint32_t default_layer_state;
 
 #ifndef NO_ACTION_LAYER
@@ -165,6 +170,21 @@ bool process_action_kb(keyrecord_t *record);
 bool process_record_kb(uint16_t keycode, keyrecord_t *record);
 bool process_record_user(uint16_t keycode, keyrecord_t *record);
 
+/* A keycode handler of process_record_quantum(), see quantum.c */
+typedef struct {
+    uint16_t min;
+    uint16_t max;
+    bool (*active)(void);
+    bool (*process)(uint16_t keycode, keyrecord_t *record);
+} process_record_handler_t;
+
+bool process_record_handlers_dispatch(uint16_t keycode, keyrecord_t *record);
+
+#ifdef PROCESS_RECORD_STATS
+extern uint32_t process_record_handler_calls;
+extern const uint8_t process_record_handler_count;
+#endif
+
 void reset_keyboard(void);
 
 void startup_user(void);
@@ -26,6 +26,7 @@
 #include "eeprom.h"
 #include "lufa.h"
 #include <math.h>
+#include <string.h>
 
 rgb_config_t rgb_matrix_config;
 
@@ -41,21 +42,100 @@ rgb_config_t rgb_matrix_config;
     #define EECONFIG_RGB_MATRIX EECONFIG_RGBLIGHT
 #endif
 
+#ifndef RGB_MATRIX_LED_PROCESS_LIMIT
+    #define RGB_MATRIX_LED_PROCESS_LIMIT 8
+#endif
+
 bool g_suspend_state = false;
 
-// Global tick at 20 Hz
+// Global tick, only advanced when a new frame starts so every slice of a
+// frame sees the same time
 uint32_t g_tick = 0;
 
-// Ticks since this key was last hit.
-uint8_t g_key_hit[DRIVER_LED_TOTAL];
+// Calls to rgb_matrix_task(), g_tick catches up to it at each new frame
+static uint32_t g_task_tick = 0;
 
 // Ticks since any key was last hit.
 uint32_t g_any_key_hit = 0;
 
+// The frame is rendered RGB_MATRIX_LED_PROCESS_LIMIT LEDs per call into
+// g_frame_buffer, then copied to the LED drivers the same way. The drivers
+// are only told to update once the whole frame is there, so a partially
+// rendered frame is never shown and no single call walks every LED.
+typedef enum {
+    RENDER_FRAME,
+    FLUSH_FRAME,
+} render_state_t;
+
+static RGB g_frame_buffer[DRIVER_LED_TOTAL];
+static render_state_t g_render_state = RENDER_FRAME;
+static uint8_t g_render_led = 0;
+static uint8_t g_render_effect;
+static bool g_render_enabled;
+static bool g_render_initialize;
+static bool g_render_indicators;
+
+// First LED under each key, so a key press doesn't search g_rgb_leds
+static uint8_t g_led_from_matrix[MATRIX_ROWS][MATRIX_COLS];
+
 #ifndef PI
 #define PI 3.14159265
 #endif
 
+// Center of the LED coordinate space used by the positional effects
+#define LED_CENTER_X 112
+#define LED_CENTER_Y 32
+
+// Per-LED terms that only depend on the layout, derived once at init so the
+// positional effects only add a per-frame phase instead of redoing the
+// float math for every LED on every tick.
+typedef struct {
+    int8_t   dx;       // x offset from the center
+    int8_t   dy;       // y offset from the center
+    int8_t   pinwheel; // 66 - |dx|, mirrors the pinwheel around the center
+    uint16_t chevron;  // |dy| + x, distance along the chevron
+} led_geometry_t;
+
+static led_geometry_t g_led_geometry[DRIVER_LED_TOTAL];
+
+static void rgb_matrix_init_geometry(void) {
+    for ( uint8_t i = 0; i < DRIVER_LED_TOTAL; i++ ) {
+        Point point = g_rgb_leds[i].point;
+        int16_t dx = (int16_t)point.x - LED_CENTER_X;
+        int16_t dy = (int16_t)point.y - LED_CENTER_Y;
+        g_led_geometry[i].dx = dx;
+        g_led_geometry[i].dy = dy;
+        g_led_geometry[i].pinwheel = 66 - abs(dx);
+        g_led_geometry[i].chevron = abs(dy) + point.x;
+    }
+}
+
+// Integer square root, enough for distances across the LED coordinate space
+static uint8_t isqrt16(uint16_t value) {
+    uint16_t root = 0;
+    uint16_t bit = 1 << 14;
+    while ( bit > value ) {
+        bit >>= 2;
+    }
+    while ( bit ) {
+        if ( value >= root + bit ) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+static uint8_t led_distance(uint8_t a, uint8_t b) {
+    int16_t dx = (int16_t)g_rgb_leds[a].point.x - g_rgb_leds[b].point.x;
+    int16_t dy = (int16_t)g_rgb_leds[a].point.y - g_rgb_leds[b].point.y;
+    // 224^2 + 64^2 doesn't fit in a 16 bit int
+    return isqrt16((uint16_t)(dx * (int32_t)dx + dy * (int32_t)dy));
+}
+
 uint32_t eeconfig_read_rgb_matrix(void) {
   return eeprom_read_dword(EECONFIG_RGB_MATRIX);
 }
@@ -82,11 +162,45 @@ void eeconfig_debug_rgb_matrix(void) {
   dprintf("rgb_matrix_config.speed = %d\n", rgb_matrix_config.speed);
 }
 
-// Last led hit
+// Recent key hits, newest first. The reactive effects derive each LED's age
+// from these instead of keeping a counter per LED that has to be swept on
+// every tick.
 #define LED_HITS_TO_REMEMBER 8
-uint8_t g_last_led_hit[LED_HITS_TO_REMEMBER] = {255};
+#define LED_HIT_MAX_AGE 255
+
+typedef struct {
+    uint8_t led;
+    uint32_t tick;
+} led_hit_t;
+
+led_hit_t g_last_led_hit[LED_HITS_TO_REMEMBER];
 uint8_t g_last_led_count = 0;
 
+static uint8_t led_hit_age(const led_hit_t *hit) {
+    uint32_t age = g_tick - hit->tick;
+    return age < LED_HIT_MAX_AGE ? age : LED_HIT_MAX_AGE;
+}
+
+// Ticks since this LED was last hit, or LED_HIT_MAX_AGE
+static uint8_t led_key_hit(uint8_t led) {
+    for (uint8_t i = 0; i < g_last_led_count; i++) {
+        if (g_last_led_hit[i].led == led) {
+            return led_hit_age(&g_last_led_hit[i]);
+        }
+    }
+    return LED_HIT_MAX_AGE;
+}
+
+static void rgb_matrix_init_led_from_matrix(void) {
+    memset(g_led_from_matrix, 0xFF, sizeof(g_led_from_matrix));
+    for (uint8_t i = DRIVER_LED_TOTAL; i-- > 0;) {
+        rgb_led led = g_rgb_leds[i];
+        if (led.matrix_co.row < MATRIX_ROWS && led.matrix_co.col < MATRIX_COLS) {
+            g_led_from_matrix[led.matrix_co.row][led.matrix_co.col] = i;
+        }
+    }
+}
+
 void map_row_column_to_led( uint8_t row, uint8_t column, uint8_t *led_i, uint8_t *led_count) {
     rgb_led led;
     *led_count = 0;
@@ -108,34 +222,43 @@ void rgb_matrix_update_pwm_buffers(void) {
 }
 
 void rgb_matrix_set_color( int index, uint8_t red, uint8_t green, uint8_t blue ) {
-    IS31FL3731_set_color( index, red, green, blue );
+    if ( index >= 0 && index < DRIVER_LED_TOTAL ) {
+        g_frame_buffer[index] = (RGB){ .r = red, .g = green, .b = blue };
+    }
+}
+
+static void rgb_matrix_set_color_range( uint8_t led_min, uint8_t led_max, uint8_t red, uint8_t green, uint8_t blue ) {
+    for ( uint8_t i = led_min; i < led_max; i++ ) {
+        rgb_matrix_set_color( i, red, green, blue );
+    }
 }
 
 void rgb_matrix_set_color_all( uint8_t red, uint8_t green, uint8_t blue ) {
-    IS31FL3731_set_color_all( red, green, blue );
+    rgb_matrix_set_color_range( 0, DRIVER_LED_TOTAL, red, green, blue );
 }
 
 
 bool process_rgb_matrix(uint16_t keycode, keyrecord_t *record) {
+    uint8_t row = record->event.key.row;
+    uint8_t col = record->event.key.col;
+    uint8_t led = (row < MATRIX_ROWS && col < MATRIX_COLS) ? g_led_from_matrix[row][col] : 0xFF;
     if ( record->event.pressed ) {
-        uint8_t led[8], led_count;
-        map_row_column_to_led(record->event.key.row, record->event.key.col, led, &led_count);
-        if (led_count > 0) {
+        if (led < DRIVER_LED_TOTAL) {
             for (uint8_t i = LED_HITS_TO_REMEMBER; i > 1; i--) {
                 g_last_led_hit[i - 1] = g_last_led_hit[i - 2];
             }
-            g_last_led_hit[0] = led[0];
+            g_last_led_hit[0] = (led_hit_t){ .led = led, .tick = g_tick };
             g_last_led_count = MIN(LED_HITS_TO_REMEMBER, g_last_led_count + 1);
         }
-        for(uint8_t i = 0; i < led_count; i++)
-            g_key_hit[led[i]] = 0;
         g_any_key_hit = 0;
     } else {
         #ifdef RGB_MATRIX_KEYRELEASES
-        uint8_t led[8], led_count;
-        map_row_column_to_led(record->event.key.row, record->event.key.col, led, &led_count);
-        for(uint8_t i = 0; i < led_count; i++)
-            g_key_hit[led[i]] = 255;
+        // age out the hits of this LED straight away
+        for (uint8_t i = 0; i < g_last_led_count; i++) {
+            if (g_last_led_hit[i].led == led) {
+                g_last_led_hit[i].tick = g_tick - LED_HIT_MAX_AGE;
+            }
+        }
 
         g_any_key_hit = 255;
         #endif
@@ -147,29 +270,29 @@ void rgb_matrix_set_suspend_state(bool state) {
     g_suspend_state = state;
 }
 
-void rgb_matrix_test(void) {
+void rgb_matrix_test(uint8_t led_min, uint8_t led_max) {
     // Mask out bits 4 and 5
     // This 2-bit value will stay the same for 16 ticks.
     switch ( (g_tick & 0x30) >> 4 )
     {
         case 0:
         {
-            rgb_matrix_set_color_all( 20, 0, 0 );
+            rgb_matrix_set_color_range( led_min, led_max, 20, 0, 0 );
             break;
         }
         case 1:
         {
-            rgb_matrix_set_color_all( 0, 20, 0 );
+            rgb_matrix_set_color_range( led_min, led_max, 0, 20, 0 );
             break;
         }
         case 2:
         {
-            rgb_matrix_set_color_all( 0, 0, 20 );
+            rgb_matrix_set_color_range( led_min, led_max, 0, 0, 20 );
             break;
         }
         case 3:
         {
-            rgb_matrix_set_color_all( 20, 20, 20 );
+            rgb_matrix_set_color_range( led_min, led_max, 20, 20, 20 );
             break;
         }
     }
@@ -217,22 +340,22 @@ void rgb_matrix_single_LED_test(void) {
 }
 
 // All LEDs off
-void rgb_matrix_all_off(void) { 
-    rgb_matrix_set_color_all( 0, 0, 0 );
+void rgb_matrix_all_off(uint8_t led_min, uint8_t led_max) {
+    rgb_matrix_set_color_range( led_min, led_max, 0, 0, 0 );
 }
 
 // Solid color
-void rgb_matrix_solid_color(void) {
+void rgb_matrix_solid_color(uint8_t led_min, uint8_t led_max) {
     HSV hsv = { .h = rgb_matrix_config.hue, .s = rgb_matrix_config.sat, .v = rgb_matrix_config.val };
     RGB rgb = hsv_to_rgb( hsv );
-    rgb_matrix_set_color_all( rgb.r, rgb.g, rgb.b );
+    rgb_matrix_set_color_range( led_min, led_max, rgb.r, rgb.g, rgb.b );
 }
 
-void rgb_matrix_solid_reactive(void) {
+void rgb_matrix_solid_reactive(uint8_t led_min, uint8_t led_max) {
 	// Relies on hue being 8-bit and wrapping
-	for ( int i=0; i<DRIVER_LED_TOTAL; i++ )
+	for ( int i=led_min; i<led_max; i++ )
 	{
-		uint16_t offset2 = g_key_hit[i]<<2;
+		uint16_t offset2 = led_key_hit(i)<<2;
 		offset2 = (offset2<=130) ? (130-offset2) : 0;
 
 		HSV hsv = { .h = rgb_matrix_config.hue+offset2, .s = 255, .v = rgb_matrix_config.val };
@@ -242,13 +365,13 @@ void rgb_matrix_solid_reactive(void) {
 }
 
 // alphas = color1, mods = color2
-void rgb_matrix_alphas_mods(void) {
+void rgb_matrix_alphas_mods(uint8_t led_min, uint8_t led_max) {
  
     RGB rgb1 = hsv_to_rgb( (HSV){ .h = rgb_matrix_config.hue, .s = rgb_matrix_config.sat, .v = rgb_matrix_config.val } );
     RGB rgb2 = hsv_to_rgb( (HSV){ .h = (rgb_matrix_config.hue + 180) % 360, .s = rgb_matrix_config.sat, .v = rgb_matrix_config.val } );
 
     rgb_led led;
-    for (int i = 0; i < DRIVER_LED_TOTAL; i++) {
+    for (int i = led_min; i < led_max; i++) {
         led = g_rgb_leds[i];
         if ( led.matrix_co.raw < 0xFF ) {
             if ( led.modifier )
@@ -263,7 +386,7 @@ void rgb_matrix_alphas_mods(void) {
     }
 }
 
-void rgb_matrix_gradient_up_down(void) {
+void rgb_matrix_gradient_up_down(uint8_t led_min, uint8_t led_max) {
     int16_t h1 = rgb_matrix_config.hue;
     int16_t h2 = (rgb_matrix_config.hue + 180) % 360;
     int16_t deltaH = h2 - h1;
@@ -287,7 +410,7 @@ void rgb_matrix_gradient_up_down(void) {
     HSV hsv = { .h = 0, .s = 255, .v = rgb_matrix_config.val };
     RGB rgb;
     Point point;
-    for ( int i=0; i<DRIVER_LED_TOTAL; i++ )
+    for ( int i=led_min; i<led_max; i++ )
     {
         // map_led_to_point( i, &point );
         point = g_rgb_leds[i].point;
@@ -301,7 +424,7 @@ void rgb_matrix_gradient_up_down(void) {
     }
 }
 
-void rgb_matrix_raindrops(bool initialize) {
+void rgb_matrix_raindrops(uint8_t led_min, uint8_t led_max, bool initialize) {
     int16_t h1 = rgb_matrix_config.hue;
     int16_t h2 = (rgb_matrix_config.hue + 180) % 360;
     int16_t deltaH = h2 - h1;
@@ -324,10 +447,13 @@ void rgb_matrix_raindrops(bool initialize) {
     HSV hsv;
     RGB rgb;
 
-    // Change one LED every tick, make sure speed is not 0
-    uint8_t led_to_change = ( g_tick & ( 0x0A / (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed) ) ) == 0 ? rand() % (DRIVER_LED_TOTAL) : 255;
+    // Change one LED every frame, make sure speed is not 0
+    static uint8_t led_to_change;
+    if ( led_min == 0 ) {
+        led_to_change = ( g_tick & ( 0x0A / (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed) ) ) == 0 ? rand() % (DRIVER_LED_TOTAL) : 255;
+    }
 
-    for ( int i=0; i<DRIVER_LED_TOTAL; i++ )
+    for ( int i=led_min; i<led_max; i++ )
     {
         // If initialize, all get set to random colors
         // If not, all but one will stay the same as before.
@@ -344,18 +470,18 @@ void rgb_matrix_raindrops(bool initialize) {
     }
 }
 
-void rgb_matrix_cycle_all(void) {
+void rgb_matrix_cycle_all(uint8_t led_min, uint8_t led_max) {
     uint8_t offset = ( g_tick << rgb_matrix_config.speed ) & 0xFF;
 
     rgb_led led;
 
     // Relies on hue being 8-bit and wrapping
-    for ( int i=0; i<DRIVER_LED_TOTAL; i++ )
+    for ( int i=led_min; i<led_max; i++ )
     {
         // map_index_to_led(i, &led);
         led = g_rgb_leds[i];
         if (led.matrix_co.raw < 0xFF) {
-            uint16_t offset2 = g_key_hit[i]<<2;
+            uint16_t offset2 = led_key_hit(i)<<2;
             offset2 = (offset2<=63) ? (63-offset2) : 0;
 
             HSV hsv = { .h = offset+offset2, .s = 255, .v = rgb_matrix_config.val };
@@ -365,48 +491,38 @@ void rgb_matrix_cycle_all(void) {
     }
 }
 
-void rgb_matrix_cycle_left_right(void) {
+void rgb_matrix_cycle_left_right(uint8_t led_min, uint8_t led_max) {
     uint8_t offset = ( g_tick << rgb_matrix_config.speed ) & 0xFF;
     HSV hsv = { .h = 0, .s = 255, .v = rgb_matrix_config.val };
     RGB rgb;
-    Point point;
-    rgb_led led;
-    for ( int i=0; i<DRIVER_LED_TOTAL; i++ )
+    for ( int i=led_min; i<led_max; i++ )
     {
-        // map_index_to_led(i, &led);
-        led = g_rgb_leds[i];
-        if (led.matrix_co.raw < 0xFF) {
-            uint16_t offset2 = g_key_hit[i]<<2;
+        const rgb_led *led = &g_rgb_leds[i];
+        if (led->matrix_co.raw < 0xFF) {
+            uint16_t offset2 = led_key_hit(i)<<2;
             offset2 = (offset2<=63) ? (63-offset2) : 0;
 
-            // map_led_to_point( i, &point );
-            point = g_rgb_leds[i].point;
             // Relies on hue being 8-bit and wrapping
-            hsv.h = point.x + offset + offset2;
+            hsv.h = led->point.x + offset + offset2;
             rgb = hsv_to_rgb( hsv );
             rgb_matrix_set_color( i, rgb.r, rgb.g, rgb.b );
         }
     }
 }
 
-void rgb_matrix_cycle_up_down(void) {
+void rgb_matrix_cycle_up_down(uint8_t led_min, uint8_t led_max) {
     uint8_t offset = ( g_tick << rgb_matrix_config.speed ) & 0xFF;
     HSV hsv = { .h = 0, .s = 255, .v = rgb_matrix_config.val };
     RGB rgb;
-    Point point;
-    rgb_led led;
-    for ( int i=0; i<DRIVER_LED_TOTAL; i++ )
+    for ( int i=led_min; i<led_max; i++ )
     {
-        // map_index_to_led(i, &led);
-        led = g_rgb_leds[i];
-        if (led.matrix_co.raw < 0xFF) {
-            uint16_t offset2 = g_key_hit[i]<<2;
+        const rgb_led *led = &g_rgb_leds[i];
+        if (led->matrix_co.raw < 0xFF) {
+            uint16_t offset2 = led_key_hit(i)<<2;
             offset2 = (offset2<=63) ? (63-offset2) : 0;
 
-            // map_led_to_point( i, &point );
-            point = g_rgb_leds[i].point;
             // Relies on hue being 8-bit and wrapping
-            hsv.h = point.y + offset + offset2;
+            hsv.h = led->point.y + offset + offset2;
             rgb = hsv_to_rgb( hsv );
             rgb_matrix_set_color( i, rgb.r, rgb.g, rgb.b );
         }
@@ -414,65 +530,75 @@ void rgb_matrix_cycle_up_down(void) {
 }
 
 
-void rgb_matrix_dual_beacon(void) {
+void rgb_matrix_dual_beacon(uint8_t led_min, uint8_t led_max) {
     HSV hsv = { .h = rgb_matrix_config.hue, .s = rgb_matrix_config.sat, .v = rgb_matrix_config.val };
     RGB rgb;
-    rgb_led led;
-    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
-        led = g_rgb_leds[i];
-        hsv.h = ((led.point.y - 32.0)* cos(g_tick * PI / 128) / 32 + (led.point.x - 112.0) * sin(g_tick * PI / 128) / (112)) * (180) + rgb_matrix_config.hue;
+    // The rotation only depends on g_tick, so scale it to Q8 once per frame
+    int32_t cos_q8 = cos(g_tick * PI / 128) * 180 / 32 * 256;
+    int32_t sin_q8 = sin(g_tick * PI / 128) * 180 / 112 * 256;
+    for (uint8_t i = led_min; i < led_max; i++) {
+        const led_geometry_t *geometry = &g_led_geometry[i];
+        hsv.h = ((geometry->dy * cos_q8 + geometry->dx * sin_q8) >> 8) + rgb_matrix_config.hue;
         rgb = hsv_to_rgb( hsv );
         rgb_matrix_set_color( i, rgb.r, rgb.g, rgb.b );
     }
 }
 
-void rgb_matrix_rainbow_beacon(void) {
+void rgb_matrix_rainbow_beacon(uint8_t led_min, uint8_t led_max) {
     HSV hsv = { .h = rgb_matrix_config.hue, .s = rgb_matrix_config.sat, .v = rgb_matrix_config.val };
     RGB rgb;
-    rgb_led led;
-    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
-        led = g_rgb_leds[i];
-        hsv.h = (1.5 * (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed)) * (led.point.y - 32.0)* cos(g_tick * PI / 128) + (1.5 * (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed)) * (led.point.x - 112.0) * sin(g_tick * PI / 128) + rgb_matrix_config.hue;
+    double scale = 1.5 * (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed);
+    int32_t cos_q8 = scale * cos(g_tick * PI / 128) * 256;
+    int32_t sin_q8 = scale * sin(g_tick * PI / 128) * 256;
+    for (uint8_t i = led_min; i < led_max; i++) {
+        const led_geometry_t *geometry = &g_led_geometry[i];
+        hsv.h = ((geometry->dy * cos_q8 + geometry->dx * sin_q8) >> 8) + rgb_matrix_config.hue;
         rgb = hsv_to_rgb( hsv );
         rgb_matrix_set_color( i, rgb.r, rgb.g, rgb.b );
     }
 }
 
-void rgb_matrix_rainbow_pinwheels(void) {
+void rgb_matrix_rainbow_pinwheels(uint8_t led_min, uint8_t led_max) {
     HSV hsv = { .h = rgb_matrix_config.hue, .s = rgb_matrix_config.sat, .v = rgb_matrix_config.val };
     RGB rgb;
-    rgb_led led;
-    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
-        led = g_rgb_leds[i];
-        hsv.h = (2 * (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed)) * (led.point.y - 32.0)* cos(g_tick * PI / 128) + (2 * (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed)) * (66 - abs(led.point.x - 112.0)) * sin(g_tick * PI / 128) + rgb_matrix_config.hue;
+    double scale = 2 * (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed);
+    int32_t cos_q8 = scale * cos(g_tick * PI / 128) * 256;
+    int32_t sin_q8 = scale * sin(g_tick * PI / 128) * 256;
+    for (uint8_t i = led_min; i < led_max; i++) {
+        const led_geometry_t *geometry = &g_led_geometry[i];
+        hsv.h = ((geometry->dy * cos_q8 + geometry->pinwheel * sin_q8) >> 8) + rgb_matrix_config.hue;
         rgb = hsv_to_rgb( hsv );
         rgb_matrix_set_color( i, rgb.r, rgb.g, rgb.b );
     }
 }
 
-void rgb_matrix_rainbow_moving_chevron(void) {
+void rgb_matrix_rainbow_moving_chevron(uint8_t led_min, uint8_t led_max) {
     HSV hsv = { .h = rgb_matrix_config.hue, .s = rgb_matrix_config.sat, .v = rgb_matrix_config.val };
     RGB rgb;
-    rgb_led led;
-    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
-        led = g_rgb_leds[i];
-        // uint8_t r = g_tick;
-        uint8_t r = 32;
-        hsv.h = (1.5 * (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed)) * abs(led.point.y - 32.0)* sin(r * PI / 128) + (1.5 * (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed)) * (led.point.x - (g_tick / 256.0 * 224)) * cos(r * PI / 128) + rgb_matrix_config.hue;
+    // The chevron angle is fixed at 45 degrees, so sin and cos are equal and
+    // the per-LED term reduces to (|dy| + x) scaled, minus a moving phase.
+    double scale = 1.5 * (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed) * cos(32 * PI / 128);
+    int32_t scale_q8 = scale * 256;
+    uint8_t phase = (int32_t)(scale * (g_tick / 256.0 * 224));
+    for (uint8_t i = led_min; i < led_max; i++) {
+        hsv.h = ((g_led_geometry[i].chevron * scale_q8) >> 8) - phase + rgb_matrix_config.hue;
         rgb = hsv_to_rgb( hsv );
         rgb_matrix_set_color( i, rgb.r, rgb.g, rgb.b );
     }
 }
 
 
-void rgb_matrix_jellybean_raindrops( bool initialize ) {
+void rgb_matrix_jellybean_raindrops(uint8_t led_min, uint8_t led_max, bool initialize) {
     HSV hsv;
     RGB rgb;
 
-    // Change one LED every tick, make sure speed is not 0
-    uint8_t led_to_change = ( g_tick & ( 0x0A / (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed) ) ) == 0 ? rand() % (DRIVER_LED_TOTAL) : 255;
+    // Change one LED every frame, make sure speed is not 0
+    static uint8_t led_to_change;
+    if ( led_min == 0 ) {
+        led_to_change = ( g_tick & ( 0x0A / (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed) ) ) == 0 ? rand() % (DRIVER_LED_TOTAL) : 255;
+    }
 
-    for ( int i=0; i<DRIVER_LED_TOTAL; i++ )
+    for ( int i=led_min; i<led_max; i++ )
     {
         // If initialize, all get set to random colors
         // If not, all but one will stay the same as before.
@@ -489,84 +615,76 @@ void rgb_matrix_jellybean_raindrops( bool initialize ) {
     }
 }
 
-void rgb_matrix_multisplash(void) {
-    // if (g_any_key_hit < 0xFF) {
-        HSV hsv = { .h = rgb_matrix_config.hue, .s = rgb_matrix_config.sat, .v = rgb_matrix_config.val };
-        RGB rgb;
-        rgb_led led;
-        for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
-            led = g_rgb_leds[i];
-            uint16_t c = 0, d = 0;
-            rgb_led last_led;
-            // if (g_last_led_count) {
-                for (uint8_t last_i = 0; last_i < g_last_led_count; last_i++) {
-                    last_led = g_rgb_leds[g_last_led_hit[last_i]];
-                    uint16_t dist = (uint16_t)sqrt(pow(led.point.x - last_led.point.x, 2) + pow(led.point.y - last_led.point.y, 2));
-                    uint16_t effect = (g_key_hit[g_last_led_hit[last_i]] << 2) - dist;
-                    c += MIN(MAX(effect, 0), 255);
-                    d += 255 - MIN(MAX(effect, 0), 255);
-                }
-            // } else {
-            //     d = 255;
-            // }
-            hsv.h = (rgb_matrix_config.hue + c) % 256;
-            hsv.v = MAX(MIN(d, 255), 0);
-            rgb = hsv_to_rgb( hsv );
-            rgb_matrix_set_color( i, rgb.r, rgb.g, rgb.b );
+void rgb_matrix_multisplash(uint8_t led_min, uint8_t led_max) {
+    HSV hsv = { .h = rgb_matrix_config.hue, .s = rgb_matrix_config.sat, .v = rgb_matrix_config.val };
+    RGB rgb;
+    // The wavefront radius of each hit only changes once per tick, so work it
+    // out before walking the LEDs.
+    uint8_t count = MIN(g_last_led_count, LED_HITS_TO_REMEMBER);
+    uint16_t radius[LED_HITS_TO_REMEMBER];
+    for (uint8_t last_i = 0; last_i < count; last_i++) {
+        radius[last_i] = led_hit_age(&g_last_led_hit[last_i]) << 2;
+    }
+    for (uint8_t i = led_min; i < led_max; i++) {
+        uint16_t c = 0, d = 0;
+        for (uint8_t last_i = 0; last_i < count; last_i++) {
+            uint8_t dist = led_distance(i, g_last_led_hit[last_i].led);
+            // LEDs the wavefront has not reached yet stay dark
+            uint8_t effect = radius[last_i] < dist ? 255 : MIN(radius[last_i] - dist, 255);
+            c += effect;
+            d += 255 - effect;
         }
-    // } else {
-        // rgb_matrix_set_color_all( 0, 0, 0 );
-    // }
+        hsv.h = (rgb_matrix_config.hue + c) % 256;
+        hsv.v = MIN(d, 255);
+        rgb = hsv_to_rgb( hsv );
+        rgb_matrix_set_color( i, rgb.r, rgb.g, rgb.b );
+    }
 }
 
 
-void rgb_matrix_splash(void) {
+void rgb_matrix_splash(uint8_t led_min, uint8_t led_max) {
     g_last_led_count = MIN(g_last_led_count, 1);
-    rgb_matrix_multisplash();
-}
-
-
-void rgb_matrix_solid_multisplash(void) {
-    // if (g_any_key_hit < 0xFF) {
-        HSV hsv = { .h = rgb_matrix_config.hue, .s = rgb_matrix_config.sat, .v = rgb_matrix_config.val };
-        RGB rgb;
-        rgb_led led;
-        for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
-            led = g_rgb_leds[i];
-            uint16_t d = 0;
-            rgb_led last_led;
-            // if (g_last_led_count) {
-                for (uint8_t last_i = 0; last_i < g_last_led_count; last_i++) {
-                    last_led = g_rgb_leds[g_last_led_hit[last_i]];
-                    uint16_t dist = (uint16_t)sqrt(pow(led.point.x - last_led.point.x, 2) + pow(led.point.y - last_led.point.y, 2));
-                    uint16_t effect = (g_key_hit[g_last_led_hit[last_i]] << 2) - dist;
-                    d += 255 - MIN(MAX(effect, 0), 255);
-                }
-            // } else {
-            //     d = 255;
-            // }
-            hsv.v = MAX(MIN(d, 255), 0);
-            rgb = hsv_to_rgb( hsv );
-            rgb_matrix_set_color( i, rgb.r, rgb.g, rgb.b );
+    rgb_matrix_multisplash(led_min, led_max);
+}
+
+
+void rgb_matrix_solid_multisplash(uint8_t led_min, uint8_t led_max) {
+    HSV hsv = { .h = rgb_matrix_config.hue, .s = rgb_matrix_config.sat, .v = rgb_matrix_config.val };
+    RGB rgb;
+    // The wavefront radius of each hit only changes once per tick, so work it
+    // out before walking the LEDs.
+    uint8_t count = MIN(g_last_led_count, LED_HITS_TO_REMEMBER);
+    uint16_t radius[LED_HITS_TO_REMEMBER];
+    for (uint8_t last_i = 0; last_i < count; last_i++) {
+        radius[last_i] = led_hit_age(&g_last_led_hit[last_i]) << 2;
+    }
+    for (uint8_t i = led_min; i < led_max; i++) {
+        uint16_t d = 0;
+        for (uint8_t last_i = 0; last_i < count; last_i++) {
+            uint8_t dist = led_distance(i, g_last_led_hit[last_i].led);
+            // LEDs the wavefront has not reached yet stay dark
+            uint8_t effect = radius[last_i] < dist ? 255 : MIN(radius[last_i] - dist, 255);
+            d += 255 - effect;
         }
-    // } else {
-        // rgb_matrix_set_color_all( 0, 0, 0 );
-    // }
+        hsv.v = MIN(d, 255);
+        rgb = hsv_to_rgb( hsv );
+        rgb_matrix_set_color( i, rgb.r, rgb.g, rgb.b );
+    }
 }
 
 
-void rgb_matrix_solid_splash(void) {
+void rgb_matrix_solid_splash(uint8_t led_min, uint8_t led_max) {
     g_last_led_count = MIN(g_last_led_count, 1);
-    rgb_matrix_solid_multisplash();
+    rgb_matrix_solid_multisplash(led_min, led_max);
 }
 
 
 // Needs eeprom access that we don't have setup currently
 
-void rgb_matrix_custom(void) {
+void rgb_matrix_custom(uint8_t led_min, uint8_t led_max) {
 //     HSV hsv;
 //     RGB rgb;
-//     for ( int i=0; i<DRIVER_LED_TOTAL; i++ )
+//     for ( int i=led_min; i<led_max; i++ )
 //     {
 //         backlight_get_key_color(i, &hsv);
 //         // Override brightness with global brightness control
@@ -576,38 +694,17 @@ void rgb_matrix_custom(void) {
 //     }
 }
 
-void rgb_matrix_task(void) {
+// Decides what the next frame shows. Everything that is per frame rather
+// than per LED happens here, so it's done once however the frame is sliced.
+static void rgb_matrix_start_frame(void) {
     static uint8_t toggle_enable_last = 255;
-	if (!rgb_matrix_config.enable) {
-    	rgb_matrix_all_off();
-        toggle_enable_last = rgb_matrix_config.enable;
-    	return;
-    }
-    // delay 1 second before driving LEDs or doing anything else
-    static uint8_t startup_tick = 0;
-    if ( startup_tick < 20 ) {
-        startup_tick++;
-        return;
-    }
-
-    g_tick++;
+    static uint8_t effect_last = 255;
 
-    if ( g_any_key_hit < 0xFFFFFFFF ) {
-        g_any_key_hit++;
-    }
+    g_tick = g_task_tick;
 
-    for ( int led = 0; led < DRIVER_LED_TOTAL; led++ ) {
-        if ( g_key_hit[led] < 255 ) {
-            if (g_key_hit[led] == 254)
-                g_last_led_count = MAX(g_last_led_count - 1, 0);
-            g_key_hit[led]++;
-        }
-    }
-
-    // Factory default magic value
-    if ( rgb_matrix_config.mode == 255 ) {
-        rgb_matrix_test();
-        return;
+    // Hits are newest first, so the expired ones are all at the end
+    while ( g_last_led_count > 0 && led_hit_age(&g_last_led_hit[g_last_led_count - 1]) >= LED_HIT_MAX_AGE - 1 ) {
+        g_last_led_count--;
     }
 
     // Ideally we would also stop sending zeros to the LED driver PWM buffers
@@ -619,77 +716,130 @@ void rgb_matrix_task(void) {
     // Keep track of the effect used last time,
     // detect change in effect, so each effect can
     // have an optional initialization.
-    static uint8_t effect_last = 255;
-    bool initialize = (effect != effect_last) || (rgb_matrix_config.enable != toggle_enable_last);
+    g_render_initialize = (effect != effect_last) || (rgb_matrix_config.enable != toggle_enable_last);
     effect_last = effect;
     toggle_enable_last = rgb_matrix_config.enable;
 
-    // this gets ticked at 20 Hz.
-    // each effect can opt to do calculations
-    // and/or request PWM buffer updates.
-    switch ( effect ) {
+    g_render_effect = effect;
+    g_render_enabled = rgb_matrix_config.enable;
+    g_render_indicators = g_render_enabled && !suspend_backlight && effect != 255;
+}
+
+static void rgb_matrix_render(uint8_t led_min, uint8_t led_max) {
+    if ( !g_render_enabled ) {
+        rgb_matrix_all_off( led_min, led_max );
+        return;
+    }
+
+    // Suspend and timeout select effect 0, which is left to rgb_matrix_custom
+    switch ( g_render_effect ) {
+        case 255:
+            // Factory default magic value
+            rgb_matrix_test( led_min, led_max );
+            break;
         case RGB_MATRIX_SOLID_COLOR:
-            rgb_matrix_solid_color();
+            rgb_matrix_solid_color( led_min, led_max );
             break;
         case RGB_MATRIX_ALPHAS_MODS:
-            rgb_matrix_alphas_mods();
+            rgb_matrix_alphas_mods( led_min, led_max );
             break;
         case RGB_MATRIX_DUAL_BEACON:
-            rgb_matrix_dual_beacon();
+            rgb_matrix_dual_beacon( led_min, led_max );
             break;
         case RGB_MATRIX_GRADIENT_UP_DOWN:
-            rgb_matrix_gradient_up_down();
+            rgb_matrix_gradient_up_down( led_min, led_max );
             break;
         case RGB_MATRIX_RAINDROPS:
-            rgb_matrix_raindrops( initialize );
+            rgb_matrix_raindrops( led_min, led_max, g_render_initialize );
             break;
         case RGB_MATRIX_CYCLE_ALL:
-            rgb_matrix_cycle_all();
+            rgb_matrix_cycle_all( led_min, led_max );
             break;
         case RGB_MATRIX_CYCLE_LEFT_RIGHT:
-            rgb_matrix_cycle_left_right();
+            rgb_matrix_cycle_left_right( led_min, led_max );
             break;
         case RGB_MATRIX_CYCLE_UP_DOWN:
-            rgb_matrix_cycle_up_down();
+            rgb_matrix_cycle_up_down( led_min, led_max );
             break;
         case RGB_MATRIX_RAINBOW_BEACON:
-            rgb_matrix_rainbow_beacon();
+            rgb_matrix_rainbow_beacon( led_min, led_max );
             break;
         case RGB_MATRIX_RAINBOW_PINWHEELS:
-            rgb_matrix_rainbow_pinwheels();
+            rgb_matrix_rainbow_pinwheels( led_min, led_max );
             break;
         case RGB_MATRIX_RAINBOW_MOVING_CHEVRON:
-            rgb_matrix_rainbow_moving_chevron();
+            rgb_matrix_rainbow_moving_chevron( led_min, led_max );
             break;
         case RGB_MATRIX_JELLYBEAN_RAINDROPS:
-            rgb_matrix_jellybean_raindrops( initialize );
+            rgb_matrix_jellybean_raindrops( led_min, led_max, g_render_initialize );
             break;
         #ifdef RGB_MATRIX_KEYPRESSES
             case RGB_MATRIX_SOLID_REACTIVE:
-                rgb_matrix_solid_reactive();
+                rgb_matrix_solid_reactive( led_min, led_max );
                 break;
             case RGB_MATRIX_SPLASH:
-                rgb_matrix_splash();
+                rgb_matrix_splash( led_min, led_max );
                 break;
             case RGB_MATRIX_MULTISPLASH:
-                rgb_matrix_multisplash();
+                rgb_matrix_multisplash( led_min, led_max );
                 break;
             case RGB_MATRIX_SOLID_SPLASH:
-                rgb_matrix_solid_splash();
+                rgb_matrix_solid_splash( led_min, led_max );
                 break;
             case RGB_MATRIX_SOLID_MULTISPLASH:
-                rgb_matrix_solid_multisplash();
+                rgb_matrix_solid_multisplash( led_min, led_max );
                 break;
         #endif
         default:
-            rgb_matrix_custom();
+            rgb_matrix_custom( led_min, led_max );
             break;
     }
+}
 
-    if ( ! suspend_backlight ) {
-        rgb_matrix_indicators();
+static bool rgb_matrix_flush(uint8_t led_min, uint8_t led_max) {
+    for ( uint8_t i = led_min; i < led_max; i++ ) {
+        IS31FL3731_set_color( i, g_frame_buffer[i].r, g_frame_buffer[i].g, g_frame_buffer[i].b );
     }
+    return led_max == DRIVER_LED_TOTAL;
+}
 
+void rgb_matrix_task(void) {
+    // delay 1 second before driving LEDs or doing anything else
+    static uint8_t startup_tick = 0;
+    if ( startup_tick < 20 ) {
+        startup_tick++;
+        return;
+    }
+
+    g_task_tick++;
+
+    if ( g_any_key_hit < 0xFFFFFFFF ) {
+        g_any_key_hit++;
+    }
+
+    if ( g_render_led == 0 && g_render_state == RENDER_FRAME ) {
+        rgb_matrix_start_frame();
+    }
+
+    uint8_t led_min = g_render_led;
+    uint8_t led_max = MIN( led_min + RGB_MATRIX_LED_PROCESS_LIMIT, DRIVER_LED_TOTAL );
+    g_render_led = led_max;
+
+    if ( g_render_state == RENDER_FRAME ) {
+        rgb_matrix_render( led_min, led_max );
+        if ( led_max == DRIVER_LED_TOTAL ) {
+            // indicators may set any LED, so they go on top of the whole frame
+            if ( g_render_indicators ) {
+                rgb_matrix_indicators();
+            }
+            g_render_state = FLUSH_FRAME;
+            g_render_led = 0;
+        }
+    } else if ( rgb_matrix_flush( led_min, led_max ) ) {
+        rgb_matrix_update_pwm_buffers();
+        g_render_state = RENDER_FRAME;
+        g_render_led = 0;
+    }
 }
 
 void rgb_matrix_indicators(void) {
@@ -737,10 +887,8 @@ void rgb_matrix_init_drivers(void) {
 
     // TODO: put the 1 second startup delay here?
 
-    // clear the key hits
-    for ( int led=0; led<DRIVER_LED_TOTAL; led++ ) {
-        g_key_hit[led] = 255;
-    }
+    rgb_matrix_init_led_from_matrix();
+    rgb_matrix_init_geometry();
 
 
     if (!eeconfig_is_enabled()) {
@@ -14,6 +14,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <math.h>
+#include <string.h>
 #include <avr/eeprom.h>
 #include <avr/interrupt.h>
 #include <util/delay.h>
@@ -445,25 +446,30 @@ void rgblight_sethsv_at(uint16_t hue, uint8_t sat, uint8_t val, uint8_t index) {
 }
 
 #ifndef RGBLIGHT_CUSTOM_DRIVER
+// The last frame sent to the strip. Animation steps often produce the same
+// colors again, and sending a frame keeps interrupts off for the whole strip,
+// so identical frames are skipped.
+static LED_TYPE led_sent[RGBLED_NUM];
+static bool led_sent_valid = false;
+
 void rgblight_set(void) {
-  if (rgblight_config.enable) {
-    #ifdef RGBW
-      ws2812_setleds_rgbw(led, RGBLED_NUM);
-    #else
-      ws2812_setleds(led, RGBLED_NUM);
-    #endif
-  } else {
+  if (!rgblight_config.enable) {
     for (uint8_t i = 0; i < RGBLED_NUM; i++) {
       led[i].r = 0;
       led[i].g = 0;
       led[i].b = 0;
     }
-    #ifdef RGBW
-      ws2812_setleds_rgbw(led, RGBLED_NUM);
-    #else
-      ws2812_setleds(led, RGBLED_NUM);
-    #endif
   }
+  if (led_sent_valid && memcmp(led, led_sent, sizeof(led)) == 0) {
+    return;
+  }
+  memcpy(led_sent, led, sizeof(led));
+  led_sent_valid = true;
+  #ifdef RGBW
+    ws2812_setleds_rgbw(led, RGBLED_NUM);
+  #else
+    ws2812_setleds(led, RGBLED_NUM);
+  #endif
 }
 #endif
 
@@ -0,0 +1,228 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+#include "send_string_queue.h"
+
+/* The queue holds items of a type byte and an interval byte, followed by
+ * either a NUL terminated copy of a RAM string or the address of a PROGMEM
+ * string.
+ */
+typedef enum {
+    ITEM_NONE,
+    ITEM_RAM,
+    ITEM_PROGMEM,
+} item_type_t;
+
+#define ITEM_HEADER_SIZE 2
+
+static uint8_t queue[SEND_STRING_QUEUE_SIZE];
+static uint8_t queue_head = 0;
+static uint8_t queue_tail = 0;
+static uint8_t queue_used = 0;
+
+/* The item being typed */
+static item_type_t item_type = ITEM_NONE;
+static uint8_t item_interval;
+static const char *item_str;
+
+/* Key of the last character, released by the next report */
+static bool release_pending = false;
+static bool release_shift;
+static uint8_t release_keycode;
+
+/* Modifiers held down with SS_DOWN, released by send_string_cancel() */
+static uint8_t held_mods = 0;
+
+static uint16_t last_report;
+static uint8_t report_wait = 0;
+
+static void queue_push(uint8_t byte)
+{
+    queue[queue_head] = byte;
+    queue_head = (queue_head + 1) % SEND_STRING_QUEUE_SIZE;
+    queue_used++;
+}
+
+static uint8_t queue_pop(void)
+{
+    uint8_t byte = queue[queue_tail];
+    queue_tail = (queue_tail + 1) % SEND_STRING_QUEUE_SIZE;
+    queue_used--;
+    return byte;
+}
+
+/* Back-pressure: types until size bytes of the queue are free */
+static void queue_reserve(uint8_t size)
+{
+    while (SEND_STRING_QUEUE_SIZE - queue_used < size) {
+        wait_ms(1);
+        send_string_task();
+    }
+}
+
+static bool item_start(void)
+{
+    if (!queue_used) return false;
+
+    item_type = queue_pop();
+    item_interval = queue_pop();
+    if (item_type == ITEM_PROGMEM) {
+        uint8_t *address = (uint8_t *)&item_str;
+        for (uint8_t i = 0; i < sizeof(item_str); i++) {
+            address[i] = queue_pop();
+        }
+    }
+    return true;
+}
+
+static uint8_t item_read(void)
+{
+    uint8_t byte;
+
+    if (item_type == ITEM_PROGMEM) {
+        byte = pgm_read_byte(item_str++);
+    } else {
+        byte = queue_pop();
+    }
+    if (!byte) {
+        item_type = ITEM_NONE;
+    }
+    return byte;
+}
+
+static void report_sent(uint8_t interval)
+{
+    last_report = timer_read();
+    report_wait = interval > SEND_STRING_REPORT_INTERVAL ? interval : SEND_STRING_REPORT_INTERVAL;
+}
+
+static void release_key(void)
+{
+    if (release_shift) {
+        del_weak_mods(MOD_BIT(KC_LSFT));
+    }
+    unregister_code(release_keycode);
+    release_pending = false;
+}
+
+void send_string_enqueue(const char *str, uint8_t interval)
+{
+    while (*str) {
+        // room for the header, one keystroke and the terminator
+        queue_reserve(ITEM_HEADER_SIZE + 3);
+
+        uint8_t room = SEND_STRING_QUEUE_SIZE - queue_used - ITEM_HEADER_SIZE - 1;
+        queue_push(ITEM_RAM);
+        queue_push(interval);
+        while (*str) {
+            // a tap, down or up code stays in the same item as its keycode
+            uint8_t length = (*str <= 3 && str[1]) ? 2 : 1;
+            if (length > room) break;
+            room -= length;
+            while (length--) {
+                queue_push(*str++);
+            }
+        }
+        queue_push(0);
+    }
+}
+
+void send_string_enqueue_P(const char *str, uint8_t interval)
+{
+    const uint8_t *address = (const uint8_t *)&str;
+
+    queue_reserve(ITEM_HEADER_SIZE + sizeof(str));
+    queue_push(ITEM_PROGMEM);
+    queue_push(interval);
+    for (uint8_t i = 0; i < sizeof(str); i++) {
+        queue_push(address[i]);
+    }
+}
+
+bool send_string_busy(void)
+{
+    return queue_used || item_type != ITEM_NONE || release_pending;
+}
+
+void send_string_cancel(void)
+{
+    queue_head = queue_tail = queue_used = 0;
+    item_type = ITEM_NONE;
+    if (release_pending) {
+        release_key();
+    }
+    if (held_mods) {
+        del_mods(held_mods);
+        held_mods = 0;
+        send_keyboard_report();
+    }
+}
+
+void send_string_task(void)
+{
+    if (!send_string_busy()) return;
+    if (timer_elapsed(last_report) < report_wait) return;
+
+    if (release_pending) {
+        release_key();
+        report_sent(item_interval);
+        return;
+    }
+
+    uint8_t ascii_code;
+    do {
+        if (item_type == ITEM_NONE && !item_start()) return;
+        ascii_code = item_read();
+    } while (!ascii_code);
+
+    uint8_t keycode;
+    switch (ascii_code) {
+        case 1:
+            // tap
+            release_keycode = item_read();
+            release_shift = false;
+            register_code(release_keycode);
+            release_pending = true;
+            report_sent(0);
+            break;
+        case 2:
+            // down
+            keycode = item_read();
+            register_code(keycode);
+            if (IS_MOD(keycode)) held_mods |= MOD_BIT(keycode);
+            report_sent(item_interval);
+            break;
+        case 3:
+            // up
+            keycode = item_read();
+            unregister_code(keycode);
+            if (IS_MOD(keycode)) held_mods &= ~MOD_BIT(keycode);
+            report_sent(item_interval);
+            break;
+        default:
+            // shift and key go down in one report and up in the next
+            release_keycode = pgm_read_byte(&ascii_to_keycode_lut[ascii_code]);
+            release_shift = pgm_read_byte(&ascii_to_shift_lut[ascii_code]);
+            if (release_shift) {
+                add_weak_mods(MOD_BIT(KC_LSFT));
+            }
+            register_code(release_keycode);
+            release_pending = true;
+            report_sent(0);
+            break;
+    }
+}
@@ -0,0 +1,64 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SEND_STRING_QUEUE_H
+#define SEND_STRING_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* With SEND_STRING_QUEUE_ENABLE, send_string() and friends return right away
+ * and the keystrokes are typed by send_string_task() from
+ * matrix_scan_quantum(), one keyboard report per SEND_STRING_REPORT_INTERVAL,
+ * while the keyboard keeps scanning and processing keys.
+ *
+ * PROGMEM strings are queued by reference, RAM strings are copied. A caller
+ * that doesn't fit in the queue waits until enough of it has been typed.
+ */
+
+/* Bytes of RAM strings that can be waiting. A queued PROGMEM string takes
+ * two bytes plus the size of a pointer.
+ */
+#ifndef SEND_STRING_QUEUE_SIZE
+#define SEND_STRING_QUEUE_SIZE 64
+#endif
+#if SEND_STRING_QUEUE_SIZE < 16 || SEND_STRING_QUEUE_SIZE > 255
+#error "SEND_STRING_QUEUE_SIZE must be between 16 and 255"
+#endif
+
+/* Polling interval of the keyboard endpoint, in ms. Sending faster than the
+ * host polls would replace reports before it reads them.
+ */
+#ifndef SEND_STRING_REPORT_INTERVAL
+  #ifdef USB_POLLING_INTERVAL_MS
+    #define SEND_STRING_REPORT_INTERVAL USB_POLLING_INTERVAL_MS
+  #else
+    #define SEND_STRING_REPORT_INTERVAL 10
+  #endif
+#endif
+
+void send_string_enqueue(const char *str, uint8_t interval);
+void send_string_enqueue_P(const char *str, uint8_t interval);
+
+/* true while anything is queued or a key of the queue is still pressed */
+bool send_string_busy(void);
+
+/* Drops everything queued and releases the keys the queue pressed */
+void send_string_cancel(void);
+
+void send_string_task(void);
+
+#endif
@@ -24,6 +24,7 @@ SOFTWARE.
 
 #include "serial_link/protocol/byte_stuffer.h"
 #include "serial_link/protocol/frame_validator.h"
+#include "serial_link/protocol/crc32.h"
 #include "serial_link/protocol/physical.h"
 #include <stdbool.h>
 
@@ -35,6 +36,9 @@ typedef struct byte_stuffer_state {
     uint16_t next_zero;
     uint16_t data_pos;
     bool long_frame;
+    // The CRC is updated while the frame is received, so that the
+    // validator doesn't need to go through the data again
+    uint32_t crc;
     uint8_t data[MAX_FRAME_SIZE];
 }byte_stuffer_state_t;
 
@@ -44,6 +48,12 @@ void init_byte_stuffer_state(byte_stuffer_state_t* state) {
     state->next_zero = 0;
     state->data_pos = 0;
     state->long_frame = false;
+    state->crc = CRC32_INIT;
+}
+
+static void store_byte(byte_stuffer_state_t* state, uint8_t data) {
+    state->data[state->data_pos++] = data;
+    state->crc = crc32_update_byte(state->crc, data);
 }
 
 void init_byte_stuffer(void) {
@@ -60,6 +70,7 @@ void byte_stuffer_recv_byte(uint8_t link, uint8_t data) {
         state->next_zero = data;
         state->long_frame = data == 0xFF;
         state->data_pos = 0;
+        state->crc = CRC32_INIT;
         return;
     }
 
@@ -68,7 +79,7 @@ void byte_stuffer_recv_byte(uint8_t link, uint8_t data) {
         if (state->next_zero == 0) {
             // The frame is completed
             if (state->data_pos > 0) {
-                validator_recv_frame(link, state->data, state->data_pos);
+                validator_recv_frame_crc(link, state->data, state->data_pos, state->crc);
             }
         }
         else {
@@ -83,6 +94,7 @@ void byte_stuffer_recv_byte(uint8_t link, uint8_t data) {
             state->next_zero = data;
             state->long_frame = data == 0xFF;
             state->data_pos = 0;
+            state->crc = CRC32_INIT;
         }
         else if (state->next_zero == 0) {
             if (state->long_frame) {
@@ -93,11 +105,11 @@ void byte_stuffer_recv_byte(uint8_t link, uint8_t data) {
             else {
                 // Special case for zeroes
                 state->next_zero = data;
-                state->data[state->data_pos++] = 0;
+                store_byte(state, 0);
             }
         }
         else {
-            state->data[state->data_pos++] = data;
+            store_byte(state, data);
         }
     }
 }
@@ -0,0 +1,44 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2018 QMK
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SERIAL_LINK_CRC32_H
+#define SERIAL_LINK_CRC32_H
+
+#include <stdint.h>
+
+// Standard reflected CRC-32 (the one used by Ethernet and zlib)
+// The running value is kept without the final xor, so frames can be
+// checksummed incrementally while they are being received
+#define CRC32_INIT 0xFFFFFFFF
+// The running value after a frame followed by its own little endian CRC
+#define CRC32_RESIDUE 0xDEBB20E3
+
+uint32_t crc32_update_byte(uint32_t crc, uint8_t data);
+uint32_t crc32_update(uint32_t crc, const uint8_t* data, uint16_t size);
+
+static inline uint32_t crc32_final(uint32_t crc) {
+    return crc ^ 0xFFFFFFFF;
+}
+
+#endif
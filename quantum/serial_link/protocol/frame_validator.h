@@ -28,6 +28,9 @@ SOFTWARE.
 #include <stdint.h>
 
 void validator_recv_frame(uint8_t link, uint8_t* data, uint16_t size);
+// Same as above, but with the running CRC of the whole frame, including the
+// CRC bytes, already calculated by the caller
+void validator_recv_frame_crc(uint8_t link, uint8_t* data, uint16_t size, uint32_t crc);
 // The buffer pointed to by the data needs 4 additional bytes
 void validator_send_frame(uint8_t link, uint8_t* data, uint16_t size);
 
@@ -31,6 +31,87 @@ SOFTWARE.
 static remote_object_t* remote_objects[MAX_REMOTE_OBJECTS];
 static uint32_t num_remote_objects = 0;
 
+#ifdef SERIAL_LINK_DELTA_ENABLE
+// The last byte of each frame is the object id, which has the top bit set
+// for delta frames, and the byte before that is a sequence number
+#define DELTA_FRAME_FLAG 0x80
+// Frames with more changes than this are sent in full instead
+#define DELTA_MAX_SIZE 64
+
+// A delta frame consists of runs of changed bytes, each one prefixed by
+// the offset and the length of the run, so the objects can't be bigger
+// than this
+#define DELTA_MAX_OBJECT_SIZE 255
+
+static uint8_t delta_frame[DELTA_MAX_SIZE + LOCAL_OBJECT_EXTRA];
+
+static delta_state_t* get_delta_state(triple_buffer_object_t* tb, uint16_t buffer_size) {
+    return (delta_state_t*)(tb->buffer + buffer_size * 3);
+}
+
+static bool encode_delta(const uint8_t* prev, const uint8_t* next, uint16_t object_size, uint8_t* out, uint16_t* out_size) {
+    uint16_t pos = 0;
+    uint16_t i = 0;
+    while (i < object_size) {
+        if (prev[i] == next[i]) {
+            i++;
+            continue;
+        }
+        // Starting a new run costs two bytes, so include up to two unchanged
+        // bytes in the current one
+        uint16_t last = i;
+        uint16_t j;
+        for (j = i + 1; j < object_size && j <= last + 3; j++) {
+            if (prev[j] != next[j]) {
+                last = j;
+            }
+        }
+        uint16_t length = last - i + 1;
+        if (pos + 2 + length >= object_size || pos + 2 + length > DELTA_MAX_SIZE) {
+            // Not smaller than a full frame
+            return false;
+        }
+        out[pos++] = i;
+        out[pos++] = length;
+        memcpy(out + pos, next + i, length);
+        pos += length;
+        i = last + 1;
+    }
+    *out_size = pos;
+    return true;
+}
+
+static bool apply_delta(uint8_t* object, uint16_t object_size, const uint8_t* data, uint16_t size) {
+    uint16_t pos = 0;
+    while (pos < size) {
+        if (size - pos < 2) {
+            return false;
+        }
+        uint8_t offset = data[pos++];
+        uint8_t length = data[pos++];
+        if (length == 0 || offset + length > object_size || pos + length > size) {
+            return false;
+        }
+        memcpy(object + offset, data + pos, length);
+        pos += length;
+    }
+    return true;
+}
+#endif
+
+static void init_object(uint8_t* start, uint16_t buffer_size) {
+    triple_buffer_object_t* tb = (triple_buffer_object_t*)start;
+    triple_buffer_init(tb);
+#ifdef SERIAL_LINK_DELTA_ENABLE
+    delta_state_t* delta = get_delta_state(tb, buffer_size);
+    delta->valid = false;
+    delta->sequence = 0;
+    delta->frames_since_keyframe = 0;
+#else
+    (void)buffer_size;
+#endif
+}
+
 void reinitialize_serial_link_transport(void) {
     num_remote_objects = 0;
 }
@@ -40,33 +121,28 @@ void add_remote_objects(remote_object_t** _remote_objects, uint32_t _num_remote_
     for(i=0;i<_num_remote_objects;i++) {
         remote_object_t* obj = _remote_objects[i];
         remote_objects[num_remote_objects++] = obj;
+        uint16_t local_size = obj->object_size + LOCAL_OBJECT_EXTRA;
         if (obj->object_type == MASTER_TO_ALL_SLAVES) {
-            triple_buffer_object_t* tb = (triple_buffer_object_t*)obj->buffer;
-            triple_buffer_init(tb);
+            init_object(obj->buffer, local_size);
             uint8_t* start = obj->buffer + LOCAL_OBJECT_SIZE(obj->object_size);
-            tb = (triple_buffer_object_t*)start;
-            triple_buffer_init(tb);
+            init_object(start, obj->object_size);
         }
         else if(obj->object_type == MASTER_TO_SINGLE_SLAVE) {
             uint8_t* start = obj->buffer;
             unsigned int j;
             for (j=0;j<NUM_SLAVES;j++) {
-                triple_buffer_object_t* tb = (triple_buffer_object_t*)start;
-                triple_buffer_init(tb);
+                init_object(start, local_size);
                 start += LOCAL_OBJECT_SIZE(obj->object_size);
             }
-            triple_buffer_object_t* tb = (triple_buffer_object_t*)start;
-            triple_buffer_init(tb);
+            init_object(start, obj->object_size);
         }
         else {
             uint8_t* start = obj->buffer;
-            triple_buffer_object_t* tb = (triple_buffer_object_t*)start;
-            triple_buffer_init(tb);
+            init_object(start, local_size);
             start += LOCAL_OBJECT_SIZE(obj->object_size);
             unsigned int j;
             for (j=0;j<NUM_SLAVES;j++) {
-                tb = (triple_buffer_object_t*)start;
-                triple_buffer_init(tb);
+                init_object(start, obj->object_size);
                 start += REMOTE_OBJECT_SIZE(obj->object_size);
             }
         }
@@ -74,53 +150,111 @@ void add_remote_objects(remote_object_t** _remote_objects, uint32_t _num_remote_
 }
 
 void transport_recv_frame(uint8_t from, uint8_t* data, uint16_t size) {
+#ifdef SERIAL_LINK_DELTA_ENABLE
+    if (size < 2) {
+        return;
+    }
+    uint8_t id = data[size-1] & ~DELTA_FRAME_FLAG;
+    bool is_delta = data[size-1] & DELTA_FRAME_FLAG;
+    uint8_t sequence = data[size-2];
+    size -= 2;
+#else
     uint8_t id = data[size-1];
+    size -= 1;
+#endif
     if (id < num_remote_objects) {
         remote_object_t* obj = remote_objects[id];
-        if (obj->object_size == size - 1) {
-            uint8_t* start;
-            if (obj->object_type == MASTER_TO_ALL_SLAVES) {
-                start = obj->buffer + LOCAL_OBJECT_SIZE(obj->object_size);
-            }
-            else if(obj->object_type == SLAVE_TO_MASTER) {
-                start = obj->buffer + LOCAL_OBJECT_SIZE(obj->object_size);
-                start += (from - 1) * REMOTE_OBJECT_SIZE(obj->object_size);
-            }
-            else {
-                start = obj->buffer + NUM_SLAVES * LOCAL_OBJECT_SIZE(obj->object_size);
+        uint8_t* start;
+        if (obj->object_type == MASTER_TO_ALL_SLAVES) {
+            start = obj->buffer + LOCAL_OBJECT_SIZE(obj->object_size);
+        }
+        else if(obj->object_type == SLAVE_TO_MASTER) {
+            start = obj->buffer + LOCAL_OBJECT_SIZE(obj->object_size);
+            start += (from - 1) * REMOTE_OBJECT_SIZE(obj->object_size);
+        }
+        else {
+            start = obj->buffer + NUM_SLAVES * LOCAL_OBJECT_SIZE(obj->object_size);
+        }
+        triple_buffer_object_t* tb = (triple_buffer_object_t*)start;
+#ifdef SERIAL_LINK_DELTA_ENABLE
+        delta_state_t* delta = get_delta_state(tb, obj->object_size);
+        if (is_delta) {
+            if (!delta->valid || sequence != (uint8_t)(delta->sequence + 1) ||
+                !apply_delta(delta->data, obj->object_size, data, size)) {
+                // A frame has been lost or corrupted, so ignore all deltas
+                // until the next full frame
+                delta->valid = false;
+                return;
             }
-            triple_buffer_object_t* tb = (triple_buffer_object_t*)start;
-            void* ptr = triple_buffer_begin_write_internal(obj->object_size, tb);
-            memcpy(ptr, data, size - 1);
-            triple_buffer_end_write_internal(tb);
         }
+        else if (obj->object_size == size) {
+            memcpy(delta->data, data, size);
+            delta->valid = true;
+        }
+        else {
+            return;
+        }
+        delta->sequence = sequence;
+        data = delta->data;
+#else
+        if (obj->object_size != size) {
+            return;
+        }
+#endif
+        void* ptr = triple_buffer_begin_write_internal(obj->object_size, tb);
+        memcpy(ptr, data, obj->object_size);
+        triple_buffer_end_write_internal(tb);
     }
 }
 
+static void send_object(remote_object_t* obj, uint8_t id, triple_buffer_object_t* tb, uint8_t dest) {
+    uint16_t buffer_size = obj->object_size + LOCAL_OBJECT_EXTRA;
+    uint8_t* ptr = (uint8_t*)triple_buffer_read_internal(buffer_size, tb);
+    if (!ptr) {
+        return;
+    }
+#ifdef SERIAL_LINK_DELTA_ENABLE
+    delta_state_t* delta = get_delta_state(tb, buffer_size);
+    uint16_t size;
+    if (delta->valid &&
+        obj->object_size <= DELTA_MAX_OBJECT_SIZE &&
+        delta->frames_since_keyframe < SERIAL_LINK_KEYFRAME_INTERVAL &&
+        encode_delta(delta->data, ptr, obj->object_size, delta_frame, &size)) {
+        memcpy(delta->data, ptr, obj->object_size);
+        delta->frames_since_keyframe++;
+        delta_frame[size++] = ++delta->sequence;
+        delta_frame[size++] = id | DELTA_FRAME_FLAG;
+        router_send_frame(dest, delta_frame, size);
+        return;
+    }
+    memcpy(delta->data, ptr, obj->object_size);
+    delta->valid = true;
+    delta->frames_since_keyframe = 0;
+    ptr[obj->object_size] = ++delta->sequence;
+    ptr[obj->object_size + 1] = id;
+    router_send_frame(dest, ptr, obj->object_size + 2);
+#else
+    ptr[obj->object_size] = id;
+    router_send_frame(dest, ptr, obj->object_size + 1);
+#endif
+}
+
 void update_transport(void) {
     unsigned int i;
     for(i=0;i<num_remote_objects;i++) {
         remote_object_t* obj = remote_objects[i];
         if (obj->object_type == MASTER_TO_ALL_SLAVES || obj->object_type == SLAVE_TO_MASTER) {
             triple_buffer_object_t* tb = (triple_buffer_object_t*)obj->buffer;
-            uint8_t* ptr = (uint8_t*)triple_buffer_read_internal(obj->object_size + LOCAL_OBJECT_EXTRA, tb);
-            if (ptr) {
-                ptr[obj->object_size] = i;
-                uint8_t dest = obj->object_type == MASTER_TO_ALL_SLAVES ? 0xFF : 0;
-                router_send_frame(dest, ptr, obj->object_size + 1);
-            }
+            uint8_t dest = obj->object_type == MASTER_TO_ALL_SLAVES ? 0xFF : 0;
+            send_object(obj, i, tb, dest);
         }
         else {
             uint8_t* start = obj->buffer;
             unsigned int j;
             for (j=0;j<NUM_SLAVES;j++) {
                 triple_buffer_object_t* tb = (triple_buffer_object_t*)start;
-                uint8_t* ptr = (uint8_t*)triple_buffer_read_internal(obj->object_size + LOCAL_OBJECT_EXTRA, tb);
-                if (ptr) {
-                    ptr[obj->object_size] = i;
-                    uint8_t dest = j + 1;
-                    router_send_frame(dest, ptr, obj->object_size + 1);
-                }
+                uint8_t dest = j + 1;
+                send_object(obj, i, tb, dest);
                 start += LOCAL_OBJECT_SIZE(obj->object_size);
             }
         }
@@ -28,9 +28,35 @@ SOFTWARE.
 #include "serial_link/protocol/triple_buffered_object.h"
 #include "serial_link/system/serial_link.h"
 
+#include <stdbool.h>
+
 #define NUM_SLAVES 8
 #define LOCAL_OBJECT_EXTRA 16
 
+#ifdef SERIAL_LINK_DELTA_ENABLE
+// In delta mode only the changed parts of an object are sent. A full copy
+// is still sent after at most this many delta frames, so that a receiver
+// which has lost a frame gets back in sync
+#ifndef SERIAL_LINK_KEYFRAME_INTERVAL
+#define SERIAL_LINK_KEYFRAME_INTERVAL 16
+#endif
+
+// Stored after the triple buffer of each local and remote object
+// On the sending side data is the last sent copy, and on the receiving
+// side it's the last received one
+typedef struct {
+    bool valid;
+    uint8_t sequence;
+    uint8_t frames_since_keyframe;
+    uint8_t data[0];
+} delta_state_t;
+
+#define DELTA_STATE_SIZE(objectsize) \
+    (sizeof(delta_state_t) + objectsize)
+#else
+#define DELTA_STATE_SIZE(objectsize) 0
+#endif
+
 // master -> slave = 1 local(target all), 1 remote object
 // slave -> master = 1 local(target 0), multiple remote objects
 // master -> single slave (multiple local, target id), 1 remote object
@@ -43,13 +69,13 @@ typedef enum {
 typedef struct {
     remote_object_type object_type;
     uint16_t object_size;
-    uint8_t buffer[] __attribute__((aligned(4)));
+    uint8_t buffer[0] __attribute__((aligned(4)));
 } remote_object_t;
 
 #define REMOTE_OBJECT_SIZE(objectsize) \
-    (sizeof(triple_buffer_object_t) + objectsize * 3)
+    (sizeof(triple_buffer_object_t) + objectsize * 3 + DELTA_STATE_SIZE(objectsize))
 #define LOCAL_OBJECT_SIZE(objectsize) \
-    (sizeof(triple_buffer_object_t) + (objectsize + LOCAL_OBJECT_EXTRA) * 3)
+    (sizeof(triple_buffer_object_t) + (objectsize + LOCAL_OBJECT_EXTRA) * 3 + DELTA_STATE_SIZE(objectsize))
 
 #define REMOTE_OBJECT_HELPER(name, type, num_local, num_remote) \
 typedef struct { \
@@ -29,6 +29,7 @@ SOFTWARE.
 extern "C" {
 #include "serial_link/protocol/byte_stuffer.h"
 #include "serial_link/protocol/frame_validator.h"
+#include "serial_link/protocol/crc32.h"
 #include "serial_link/protocol/physical.h"
 }
 
@@ -60,7 +61,9 @@ public:
 ByteStuffer* ByteStuffer::Instance = nullptr;
 
 extern "C" {
-    void validator_recv_frame(uint8_t link, uint8_t* data, uint16_t size) {
+    void validator_recv_frame_crc(uint8_t link, uint8_t* data, uint16_t size, uint32_t crc) {
+        // The running CRC should always match the received data
+        EXPECT_EQ(crc32_update(CRC32_INIT, data, size), crc);
         ByteStuffer::Instance->validator_recv_frame(link, data, size);
     }
 
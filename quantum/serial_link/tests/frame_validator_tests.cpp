@@ -26,6 +26,7 @@ SOFTWARE.
 #include "gmock/gmock.h"
 extern "C" {
 #include "serial_link/protocol/frame_validator.h"
+#include "serial_link/protocol/crc32.h"
 }
 
 using testing::_;
@@ -113,3 +114,40 @@ TEST_F(FrameValidator, sends_five_bytes_with_correct_crc) {
         .With(Args<1, 2>(ElementsAreArray(expected)));
     validator_send_frame(0, original, 5);
 }
+
+TEST_F(FrameValidator, validates_frame_with_precalculated_crc) {
+    uint8_t data[] = {1, 2, 3, 4, 5, 0xF4, 0x99, 0x0B, 0x47};
+    EXPECT_CALL(*this, route_incoming_frame(_, _, _))
+        .With(Args<1, 2>(ElementsAreArray(data, 5)));
+    validator_recv_frame_crc(0, data, 9, CRC32_RESIDUE);
+}
+
+TEST_F(FrameValidator, does_not_validate_frame_with_incorrect_precalculated_crc) {
+    uint8_t data[] = {1, 2, 3, 4, 5, 0xF4, 0x99, 0x0B, 0x47};
+    EXPECT_CALL(*this, route_incoming_frame(_, _, _))
+        .Times(0);
+    validator_recv_frame_crc(0, data, 9, CRC32_RESIDUE ^ 1);
+}
+
+TEST_F(FrameValidator, calculates_standard_crc_check_value) {
+    const uint8_t data[] = "123456789";
+    EXPECT_EQ(0xCBF43926, crc32_final(crc32_update(CRC32_INIT, data, 9)));
+}
+
+TEST_F(FrameValidator, calculates_same_crc_bytewise_and_in_blocks) {
+    uint8_t data[23];
+    for (unsigned i = 0; i < sizeof(data); i++) {
+        data[i] = i * 37 + 11;
+    }
+    // Try all lengths and alignments, to cover the tail handling of the
+    // four byte blocks
+    for (unsigned start = 0; start < 4; start++) {
+        for (unsigned size = 0; size <= sizeof(data) - start; size++) {
+            uint32_t bytewise = CRC32_INIT;
+            for (unsigned i = 0; i < size; i++) {
+                bytewise = crc32_update_byte(bytewise, data[start + i]);
+            }
+            EXPECT_EQ(bytewise, crc32_update(CRC32_INIT, data + start, size));
+        }
+    }
+}
@@ -0,0 +1,215 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2018 QMK
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+using testing::_;
+
+extern "C" {
+#include "serial_link/protocol/transport.h"
+}
+
+struct test_object {
+    uint8_t data[32];
+};
+
+MASTER_TO_ALL_SLAVES_OBJECT(master_to_slave, test_object);
+SLAVE_TO_MASTER_OBJECT(slave_to_master, test_object);
+
+static remote_object_t* test_remote_objects[] = {
+    REMOTE_OBJECT(master_to_slave),
+    REMOTE_OBJECT(slave_to_master),
+};
+
+class TransportDelta : public testing::Test {
+public:
+    TransportDelta() {
+        Instance = this;
+        add_remote_objects(test_remote_objects, sizeof(test_remote_objects) / sizeof(remote_object_t*));
+    }
+
+    ~TransportDelta() {
+        Instance = nullptr;
+        reinitialize_serial_link_transport();
+    }
+
+    MOCK_METHOD0(signal_data_written, void ());
+
+    void router_send_frame(uint8_t destination, uint8_t* data, uint16_t size) {
+        sent_frames.emplace_back(data, data + size);
+    }
+
+    // Writes the object, and returns the size of the frame that was sent
+    size_t write_master_to_slave(const test_object& value) {
+        *begin_write_master_to_slave() = value;
+        end_write_master_to_slave();
+        sent_frames.clear();
+        update_transport();
+        EXPECT_EQ(sent_frames.size(), 1);
+        return sent_frames.empty() ? 0 : sent_frames[0].size();
+    }
+
+    void receive_sent_frame(uint8_t from) {
+        transport_recv_frame(from, sent_frames[0].data(), sent_frames[0].size());
+    }
+
+    static TransportDelta* Instance;
+
+    std::vector<std::vector<uint8_t>> sent_frames;
+};
+
+TransportDelta* TransportDelta::Instance = nullptr;
+
+extern "C" {
+void signal_data_written(void) {
+    TransportDelta::Instance->signal_data_written();
+}
+
+void router_send_frame(uint8_t destination, uint8_t* data, uint16_t size) {
+    TransportDelta::Instance->router_send_frame(destination, data, size);
+}
+}
+
+TEST_F(TransportDelta, sends_full_object_first) {
+    EXPECT_CALL(*this, signal_data_written()).Times(1);
+    test_object obj = {};
+    obj.data[3] = 1;
+    EXPECT_EQ(write_master_to_slave(obj), sizeof(test_object) + 2);
+    receive_sent_frame(0);
+    test_object* received = read_master_to_slave();
+    ASSERT_NE(received, nullptr);
+    EXPECT_EQ(received->data[3], 1);
+}
+
+TEST_F(TransportDelta, sends_only_changed_bytes) {
+    EXPECT_CALL(*this, signal_data_written()).Times(3);
+    test_object obj = {};
+    write_master_to_slave(obj);
+    receive_sent_frame(0);
+    obj.data[5] = 7;
+    obj.data[20] = 9;
+    obj.data[21] = 10;
+    // Two runs of offset, length and data, followed by the sequence and id
+    EXPECT_EQ(write_master_to_slave(obj), 3 + 4 + 2);
+    receive_sent_frame(0);
+    // Nothing changed
+    EXPECT_EQ(write_master_to_slave(obj), 2);
+    receive_sent_frame(0);
+    test_object* received = read_master_to_slave();
+    ASSERT_NE(received, nullptr);
+    EXPECT_EQ(memcmp(received, &obj, sizeof(obj)), 0);
+}
+
+TEST_F(TransportDelta, merges_runs_separated_by_short_gaps) {
+    EXPECT_CALL(*this, signal_data_written()).Times(2);
+    test_object obj = {};
+    write_master_to_slave(obj);
+    obj.data[0] = 1;
+    obj.data[3] = 1;
+    EXPECT_EQ(write_master_to_slave(obj), 2 + 4 + 2);
+}
+
+TEST_F(TransportDelta, sends_full_object_when_too_much_changed) {
+    EXPECT_CALL(*this, signal_data_written()).Times(2);
+    test_object obj = {};
+    write_master_to_slave(obj);
+    for (int i = 0; i < 32; i += 2) {
+        obj.data[i] = 1;
+    }
+    EXPECT_EQ(write_master_to_slave(obj), sizeof(test_object) + 2);
+}
+
+TEST_F(TransportDelta, sends_periodic_keyframes) {
+    EXPECT_CALL(*this, signal_data_written()).Times(SERIAL_LINK_KEYFRAME_INTERVAL + 2);
+    test_object obj = {};
+    write_master_to_slave(obj);
+    for (int i = 0; i < SERIAL_LINK_KEYFRAME_INTERVAL; i++) {
+        obj.data[0] = i + 1;
+        EXPECT_EQ(write_master_to_slave(obj), 2 + 1 + 2);
+    }
+    EXPECT_EQ(write_master_to_slave(obj), sizeof(test_object) + 2);
+}
+
+TEST_F(TransportDelta, ignores_deltas_after_lost_frame_until_keyframe) {
+    EXPECT_CALL(*this, signal_data_written()).Times(SERIAL_LINK_KEYFRAME_INTERVAL + 2);
+    test_object obj = {};
+    write_master_to_slave(obj);
+    receive_sent_frame(0);
+    EXPECT_NE(read_master_to_slave(), nullptr);
+    obj.data[0] = 1;
+    write_master_to_slave(obj);
+    // The frame is lost, so the next delta can't be applied
+    obj.data[1] = 2;
+    write_master_to_slave(obj);
+    receive_sent_frame(0);
+    EXPECT_EQ(read_master_to_slave(), nullptr);
+    int i;
+    for (i = 2; i < SERIAL_LINK_KEYFRAME_INTERVAL; i++) {
+        obj.data[i] = i;
+        write_master_to_slave(obj);
+        receive_sent_frame(0);
+        EXPECT_EQ(read_master_to_slave(), nullptr);
+    }
+    EXPECT_EQ(write_master_to_slave(obj), sizeof(test_object) + 2);
+    receive_sent_frame(0);
+    test_object* received = read_master_to_slave();
+    ASSERT_NE(received, nullptr);
+    EXPECT_EQ(memcmp(received, &obj, sizeof(obj)), 0);
+}
+
+TEST_F(TransportDelta, ignores_corrupt_delta) {
+    EXPECT_CALL(*this, signal_data_written()).Times(2);
+    test_object obj = {};
+    write_master_to_slave(obj);
+    receive_sent_frame(0);
+    read_master_to_slave();
+    obj.data[31] = 1;
+    write_master_to_slave(obj);
+    // Move the run past the end of the object
+    sent_frames[0][0] = 32;
+    receive_sent_frame(0);
+    EXPECT_EQ(read_master_to_slave(), nullptr);
+}
+
+TEST_F(TransportDelta, tracks_each_slave_separately) {
+    EXPECT_CALL(*this, signal_data_written()).Times(2);
+    test_object obj = {};
+    *begin_write_slave_to_master() = obj;
+    end_write_slave_to_master();
+    update_transport();
+    transport_recv_frame(1, sent_frames[0].data(), sent_frames[0].size());
+    obj.data[4] = 4;
+    *begin_write_slave_to_master() = obj;
+    end_write_slave_to_master();
+    sent_frames.clear();
+    update_transport();
+    // Slave 2 hasn't received the full frame, so it can't use the delta
+    transport_recv_frame(2, sent_frames[0].data(), sent_frames[0].size());
+    EXPECT_EQ(read_slave_to_master(1), nullptr);
+    transport_recv_frame(1, sent_frames[0].data(), sent_frames[0].size());
+    test_object* received = read_slave_to_master(0);
+    ASSERT_NE(received, nullptr);
+    EXPECT_EQ(received->data[4], 4);
+}
@@ -0,0 +1,314 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef F_CPU
+#define F_CPU 16000000
+#endif
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <stdbool.h>
+#include "timer.h"
+#include "avr/timer_avr.h"
+#include "serial.h"
+
+#ifndef USE_I2C
+
+// Bits are timed with the compare B unit of Timer0, which keeps running
+// alongside the 1ms system tick on compare A
+#define TIMER_PERIOD (TIMER_RAW_TOP + 1)
+#define SERIAL_BIT_TICKS (TIMER_RAW_FREQ / SERIAL_BAUD)
+
+#if SERIAL_BIT_TICKS < 4 || SERIAL_BIT_TICKS * 2 > TIMER_PERIOD
+#  error "SERIAL_BAUD is out of range for the Timer0 tick rate"
+#endif
+
+#if SERIAL_SLAVE_BUFFER_LENGTH > SERIAL_MASTER_BUFFER_LENGTH
+#  define MAX_FRAME_SIZE (SERIAL_SLAVE_BUFFER_LENGTH + SERIAL_FRAME_OVERHEAD)
+#else
+#  define MAX_FRAME_SIZE (SERIAL_MASTER_BUFFER_LENGTH + SERIAL_FRAME_OVERHEAD)
+#endif
+
+// Each byte is a start bit, 8 data bits sent LSB first and two stop bits
+#define STOP_BIT 8
+#define NEXT_START_BIT 10
+
+// A frame whose bytes are further apart than this is discarded
+#define SERIAL_BYTE_TIMEOUT 2
+
+#define SLAVE_DATA_CORRUPT (1<<0)
+
+uint8_t volatile serial_slave_buffer[SERIAL_SLAVE_BUFFER_LENGTH] = {0};
+uint8_t volatile serial_master_buffer[SERIAL_MASTER_BUFFER_LENGTH] = {0};
+
+static bool is_master;
+static volatile uint8_t status = 0;
+
+static uint8_t tx_frame[MAX_FRAME_SIZE];
+static uint8_t tx_size;
+static volatile uint8_t tx_pos;
+static volatile uint8_t tx_bit;
+static volatile bool tx_active = false;
+static volatile bool tx_released;
+static volatile bool tx_collision = false;
+static bool tx_pending = true;
+static uint16_t tx_time;
+
+static uint8_t rx_frame[MAX_FRAME_SIZE];
+static uint8_t rx_size;
+static volatile uint8_t* rx_buffer;
+static volatile uint8_t rx_pos = 0;
+static volatile uint8_t rx_bit;
+static volatile uint8_t rx_byte;
+static volatile bool rx_active = false;
+static volatile uint16_t rx_byte_time;
+static volatile serial_frame_rx_t rx_state = {};
+
+// The line is open drain, a one is sent by letting the pull-up take it
+// high, so both halves can never drive it against each other
+inline static
+void serial_release(void) {
+  SERIAL_PIN_DDR  &= ~SERIAL_PIN_MASK;
+  SERIAL_PIN_PORT |= SERIAL_PIN_MASK;
+}
+
+inline static
+void serial_low(void) {
+  SERIAL_PIN_PORT &= ~SERIAL_PIN_MASK;
+  SERIAL_PIN_DDR  |= SERIAL_PIN_MASK;
+}
+
+inline static
+uint8_t serial_read_pin(void) {
+  return !!(SERIAL_PIN_INPUT & SERIAL_PIN_MASK);
+}
+
+inline static
+void serial_write_pin(uint8_t bit) {
+  tx_released = bit;
+  if (bit) {
+    serial_release();
+  } else {
+    serial_low();
+  }
+}
+
+inline static
+void start_detect_enable(void) {
+  EIFR = SERIAL_PIN_INTERRUPT_FLAG;
+  EIMSK |= SERIAL_PIN_INTERRUPT_MASK;
+}
+
+inline static
+void start_detect_disable(void) {
+  EIMSK &= ~SERIAL_PIN_INTERRUPT_MASK;
+}
+
+// Schedules the next compare B interrupt relative to the previous one, so
+// that the interrupt latency doesn't accumulate over the bits of a byte
+inline static
+void bit_timer_schedule(uint8_t ticks) {
+  uint16_t next = OCR0B + ticks;
+  if (next >= TIMER_PERIOD) {
+    next -= TIMER_PERIOD;
+  }
+  OCR0B = next;
+}
+
+inline static
+void bit_timer_start(uint8_t from, uint8_t ticks) {
+  OCR0B = from;
+  bit_timer_schedule(ticks);
+  TIFR0 = _BV(OCF0B);
+  TIMSK0 |= _BV(OCIE0B);
+}
+
+inline static
+void bit_timer_stop(void) {
+  TIMSK0 &= ~_BV(OCIE0B);
+}
+
+static void serial_init(void) {
+  tx_size = (is_master ? SERIAL_MASTER_BUFFER_LENGTH : SERIAL_SLAVE_BUFFER_LENGTH) + SERIAL_FRAME_OVERHEAD;
+  rx_size = (is_master ? SERIAL_SLAVE_BUFFER_LENGTH : SERIAL_MASTER_BUFFER_LENGTH) + SERIAL_FRAME_OVERHEAD;
+  rx_buffer = is_master ? serial_slave_buffer : serial_master_buffer;
+  tx_frame[tx_size - 1] = serial_frame_checksum(tx_frame, tx_size - 1);
+  serial_release();
+  SERIAL_PIN_INTERRUPT_INIT();
+  start_detect_enable();
+}
+
+void serial_master_init(void) {
+  is_master = true;
+  serial_init();
+}
+
+void serial_slave_init(void) {
+  is_master = false;
+  // The slave never runs keyboard_init, so start Timer0 here. The master's
+  // tick is already running and must not be reset
+  timer_init();
+  serial_init();
+}
+
+static void receive_frame(void) {
+  if (serial_frame_receive(&rx_state, rx_frame, rx_size, rx_buffer, timer_read()) == SERIAL_FRAME_CORRUPT) {
+    status |= SLAVE_DATA_CORRUPT;
+  } else {
+    status &= ~SLAVE_DATA_CORRUPT;
+  }
+}
+
+inline static
+void receive_bit(void) {
+  if (rx_bit < STOP_BIT) {
+    rx_byte |= serial_read_pin() << rx_bit;
+    rx_bit++;
+    bit_timer_schedule(SERIAL_BIT_TICKS);
+    return;
+  }
+
+  bit_timer_stop();
+  rx_active = false;
+  if (serial_read_pin()) {
+    rx_frame[rx_pos++] = rx_byte;
+    if (rx_pos == rx_size) {
+      receive_frame();
+      rx_pos = 0;
+    }
+  } else {
+    // No stop bit, so we are out of sync with the sender
+    rx_pos = 0;
+  }
+  start_detect_enable();
+}
+
+inline static
+void transmit_bit(void) {
+  if (tx_released && !serial_read_pin()) {
+    // The other half started sending at the same time, so give up and try
+    // again later
+    bit_timer_stop();
+    serial_release();
+    tx_active = false;
+    tx_collision = true;
+    start_detect_enable();
+    return;
+  }
+
+  if (tx_bit < STOP_BIT) {
+    serial_write_pin((tx_frame[tx_pos] >> tx_bit) & 1);
+    tx_bit++;
+  } else if (tx_bit < NEXT_START_BIT) {
+    serial_write_pin(1);
+    tx_bit++;
+  } else if (++tx_pos < tx_size) {
+    serial_write_pin(0);
+    tx_bit = 0;
+  } else {
+    bit_timer_stop();
+    tx_active = false;
+    start_detect_enable();
+    return;
+  }
+  bit_timer_schedule(SERIAL_BIT_TICKS);
+}
+
+// Start bit of a byte sent by the other half
+ISR(SERIAL_PIN_INTERRUPT) {
+  uint8_t now = TCNT0;
+  start_detect_disable();
+
+  uint16_t time = timer_read();
+  if (rx_pos != 0 && TIMER_DIFF_16(time, rx_byte_time) > SERIAL_BYTE_TIMEOUT) {
+    // The rest of the previous frame never arrived
+    rx_pos = 0;
+  }
+  rx_byte_time = time;
+  rx_active = true;
+  rx_bit = 0;
+  rx_byte = 0;
+
+  // Sample in the middle of the first data bit
+  bit_timer_start(now, SERIAL_BIT_TICKS + SERIAL_BIT_TICKS / 2);
+}
+
+ISR(TIMER0_COMPB_vect) {
+  if (tx_active) {
+    transmit_bit();
+  } else {
+    receive_bit();
+  }
+}
+
+static bool transmit_start(void) {
+  bool started = false;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    if (!rx_active && rx_pos == 0 && serial_read_pin()) {
+      start_detect_disable();
+      tx_active = true;
+      tx_collision = false;
+      tx_pos = 0;
+      tx_bit = 0;
+      serial_write_pin(0);
+      bit_timer_start(TCNT0, SERIAL_BIT_TICKS);
+      started = true;
+    }
+  }
+  return started;
+}
+
+bool serial_slave_data_corrupt(void) {
+  return status & SLAVE_DATA_CORRUPT;
+}
+
+int serial_update_buffers(void) {
+  uint16_t now = timer_read();
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    // Drop a frame that was cut off, this also recovers the receiver if
+    // timer_init has disabled the bit timer in the middle of a byte
+    if (!tx_active && (rx_active || rx_pos != 0) &&
+        TIMER_DIFF_16(now, rx_byte_time) > SERIAL_BYTE_TIMEOUT) {
+      bit_timer_stop();
+      rx_active = false;
+      rx_pos = 0;
+      start_detect_enable();
+    }
+  }
+
+  if (!tx_active) {
+    volatile uint8_t* buffer = is_master ? serial_master_buffer : serial_slave_buffer;
+    if (serial_frame_update(tx_frame, tx_size, buffer)) {
+      tx_pending = true;
+    }
+
+    bool send = serial_frame_send_due(tx_pending, tx_collision, is_master, TIMER_DIFF_16(now, tx_time));
+    if (send && transmit_start()) {
+      tx_pending = false;
+      tx_time = now;
+    }
+  }
+
+  bool connected;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    connected = serial_frame_connected(&rx_state, now);
+  }
+  return connected ? 0 : 1;
+}
+
+#endif
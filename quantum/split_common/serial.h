@@ -0,0 +1,68 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPLIT_SERIAL_H
+#define SPLIT_SERIAL_H
+
+#include "config.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include "serial_frame.h"
+
+/* Single wire half duplex link between the two halves of a split keyboard
+ *
+ * Both sides send their buffer as a frame of UART style bytes whenever it
+ * changes, and at least every SERIAL_HEARTBEAT_INTERVAL milliseconds. The
+ * bits are timed by the Timer0 compare B interrupt, and the start of each
+ * byte is detected by the pin change interrupt, so nothing blocks or
+ * disables interrupts for more than a few microseconds.
+ */
+
+#ifndef SERIAL_PIN_DDR
+#  define SERIAL_PIN_DDR DDRD
+#  define SERIAL_PIN_PORT PORTD
+#  define SERIAL_PIN_INPUT PIND
+#  define SERIAL_PIN_MASK _BV(PD0)
+#  define SERIAL_PIN_INTERRUPT INT0_vect
+#  define SERIAL_PIN_INTERRUPT_MASK _BV(INT0)
+#  define SERIAL_PIN_INTERRUPT_FLAG _BV(INTF0)
+// Falling edge
+#  define SERIAL_PIN_INTERRUPT_INIT() (EICRA = (EICRA & ~(_BV(ISC00) | _BV(ISC01))) | _BV(ISC01))
+#endif
+
+#ifndef SERIAL_BAUD
+#  define SERIAL_BAUD 20000
+#endif
+
+#ifndef SERIAL_SLAVE_BUFFER_LENGTH
+#  define SERIAL_SLAVE_BUFFER_LENGTH ((MATRIX_COLS+7)/8 * MATRIX_ROWS/2)
+#endif
+#ifndef SERIAL_MASTER_BUFFER_LENGTH
+#  define SERIAL_MASTER_BUFFER_LENGTH 1
+#endif
+
+// Buffers for master - slave communication
+extern volatile uint8_t serial_slave_buffer[SERIAL_SLAVE_BUFFER_LENGTH];
+extern volatile uint8_t serial_master_buffer[SERIAL_MASTER_BUFFER_LENGTH];
+
+void serial_master_init(void);
+void serial_slave_init(void);
+// Called on every scan by both halves. Sends the local buffer if it has
+// changed, and returns 1 if the other half hasn't been heard from lately
+int serial_update_buffers(void);
+bool serial_slave_data_corrupt(void);
+
+#endif
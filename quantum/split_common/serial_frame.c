@@ -0,0 +1,76 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "timer.h"
+#include "serial_frame.h"
+
+uint8_t serial_frame_checksum(const uint8_t* frame, uint8_t size) {
+  // Seeded so that a line stuck low doesn't produce a valid frame
+  uint8_t checksum = 0x5A;
+  for (uint8_t i = 0; i < size; ++i) {
+    checksum += frame[i];
+  }
+  return checksum;
+}
+
+bool serial_frame_update(uint8_t* frame, uint8_t size, const volatile uint8_t* buffer) {
+  bool changed = false;
+  for (uint8_t i = 0; i < size - SERIAL_FRAME_OVERHEAD; ++i) {
+    if (frame[i + 1] != buffer[i]) {
+      frame[i + 1] = buffer[i];
+      changed = true;
+    }
+  }
+  if (changed) {
+    frame[0]++;
+  }
+  frame[size - 1] = serial_frame_checksum(frame, size - 1);
+  return changed;
+}
+
+serial_frame_status_t serial_frame_receive(volatile serial_frame_rx_t* rx, const uint8_t* frame, uint8_t size,
+                                           volatile uint8_t* buffer, uint16_t now) {
+  if (serial_frame_checksum(frame, size - 1) != frame[size - 1]) {
+    return SERIAL_FRAME_CORRUPT;
+  }
+  rx->time = now;
+  if (rx->valid && frame[0] == rx->sequence) {
+    return SERIAL_FRAME_REPEAT;
+  }
+  for (uint8_t i = 0; i < size - SERIAL_FRAME_OVERHEAD; ++i) {
+    buffer[i] = frame[i + 1];
+  }
+  rx->sequence = frame[0];
+  rx->valid = true;
+  return SERIAL_FRAME_NEW;
+}
+
+bool serial_frame_connected(volatile serial_frame_rx_t* rx, uint16_t now) {
+  bool connected = rx->valid && TIMER_DIFF_16(now, rx->time) < SERIAL_TIMEOUT;
+  // Forget the old sequence number, so the first frame after a reconnect is
+  // always used
+  rx->valid = connected;
+  return connected;
+}
+
+bool serial_frame_send_due(bool pending, bool collision, bool is_master, uint16_t elapsed) {
+  if (collision) {
+    // Back off for a different time on each side, so the retries don't
+    // collide again
+    return elapsed >= (is_master ? 1 : 3);
+  }
+  return pending || elapsed >= SERIAL_HEARTBEAT_INTERVAL;
+}
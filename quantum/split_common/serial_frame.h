@@ -0,0 +1,67 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPLIT_SERIAL_FRAME_H
+#define SPLIT_SERIAL_FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Framing of the split serial link, apart from the bit timing in serial.c
+ *
+ * A frame is a sequence number, the buffer and a checksum. The sequence
+ * number only changes when the buffer does, so the receiver can skip
+ * heartbeats that carry data it already has.
+ */
+#define SERIAL_FRAME_OVERHEAD 2
+
+#ifndef SERIAL_HEARTBEAT_INTERVAL
+#  define SERIAL_HEARTBEAT_INTERVAL 50
+#endif
+
+// The other half is considered disconnected when nothing has been received
+// for this long
+#ifndef SERIAL_TIMEOUT
+#  define SERIAL_TIMEOUT (SERIAL_HEARTBEAT_INTERVAL * 3)
+#endif
+
+typedef enum {
+  SERIAL_FRAME_CORRUPT,
+  SERIAL_FRAME_REPEAT,
+  SERIAL_FRAME_NEW,
+} serial_frame_status_t;
+
+// Receiver state, updated from the interrupt on the AVR
+typedef struct {
+  uint16_t time;  // of the last valid frame
+  uint8_t sequence;
+  bool valid;
+} serial_frame_rx_t;
+
+uint8_t serial_frame_checksum(const uint8_t* frame, uint8_t size);
+// Copies buffer into the frame, and starts a new sequence number if it
+// changed. Returns whether it did
+bool serial_frame_update(uint8_t* frame, uint8_t size, const volatile uint8_t* buffer);
+// Checks a received frame, and copies it to buffer if it is new
+serial_frame_status_t serial_frame_receive(volatile serial_frame_rx_t* rx, const uint8_t* frame, uint8_t size,
+                                           volatile uint8_t* buffer, uint16_t now);
+// Whether a valid frame has arrived within SERIAL_TIMEOUT. After a timeout
+// the next frame is new whatever its sequence number
+bool serial_frame_connected(volatile serial_frame_rx_t* rx, uint16_t now);
+// Whether to send now, elapsed is the time since the last send
+bool serial_frame_send_due(bool pending, bool collision, bool is_master, uint16_t elapsed);
+
+#endif
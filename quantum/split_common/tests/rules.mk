@@ -0,0 +1,3 @@
+split_serial_frame_SRC := \
+	$(QUANTUM_PATH)/split_common/tests/serial_frame_tests.cpp \
+	$(QUANTUM_PATH)/split_common/serial_frame.c
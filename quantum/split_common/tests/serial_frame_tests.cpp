@@ -0,0 +1,121 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "split_common/serial_frame.h"
+}
+
+#define BUFFER_LENGTH 3
+#define FRAME_SIZE (BUFFER_LENGTH + SERIAL_FRAME_OVERHEAD)
+
+class SerialFrame : public testing::Test {
+  protected:
+    uint8_t frame[FRAME_SIZE] = {};
+    uint8_t sent[BUFFER_LENGTH] = {};
+    uint8_t received[BUFFER_LENGTH] = {};
+    serial_frame_rx_t rx = {};
+
+    serial_frame_status_t receive(uint16_t now) {
+        return serial_frame_receive(&rx, frame, FRAME_SIZE, received, now);
+    }
+};
+
+TEST_F(SerialFrame, AChangedBufferStartsANewSequence) {
+    sent[1] = 0x42;
+    EXPECT_TRUE(serial_frame_update(frame, FRAME_SIZE, sent));
+    EXPECT_EQ(frame[0], 1);
+    EXPECT_EQ(frame[2], 0x42);
+    EXPECT_FALSE(serial_frame_update(frame, FRAME_SIZE, sent));
+    EXPECT_EQ(frame[0], 1);
+}
+
+TEST_F(SerialFrame, AnEmptyFrameHasANonZeroChecksum) {
+    // a line held low reads as all zero bytes
+    EXPECT_NE(serial_frame_checksum(frame, FRAME_SIZE - 1), 0);
+    EXPECT_EQ(receive(0), SERIAL_FRAME_CORRUPT);
+    EXPECT_FALSE(rx.valid);
+}
+
+TEST_F(SerialFrame, ANewFrameIsCopied) {
+    sent[0] = 1;
+    sent[2] = 3;
+    serial_frame_update(frame, FRAME_SIZE, sent);
+    EXPECT_EQ(receive(10), SERIAL_FRAME_NEW);
+    EXPECT_EQ(received[0], 1);
+    EXPECT_EQ(received[2], 3);
+    EXPECT_EQ(rx.time, 10);
+}
+
+TEST_F(SerialFrame, ACorruptFrameIsNotCopied) {
+    sent[0] = 1;
+    serial_frame_update(frame, FRAME_SIZE, sent);
+    frame[1] ^= 0x10;
+    EXPECT_EQ(receive(10), SERIAL_FRAME_CORRUPT);
+    EXPECT_EQ(received[0], 0);
+}
+
+TEST_F(SerialFrame, AHeartbeatWithTheSameSequenceIsNotCopied) {
+    sent[0] = 1;
+    serial_frame_update(frame, FRAME_SIZE, sent);
+    EXPECT_EQ(receive(10), SERIAL_FRAME_NEW);
+    received[0] = 0;
+    EXPECT_EQ(receive(60), SERIAL_FRAME_REPEAT);
+    EXPECT_EQ(received[0], 0);
+    // but it still keeps the link alive
+    EXPECT_EQ(rx.time, 60);
+}
+
+TEST_F(SerialFrame, TheLinkTimesOutWithoutValidFrames) {
+    EXPECT_FALSE(serial_frame_connected(&rx, 0));
+    serial_frame_update(frame, FRAME_SIZE, sent);
+    receive(100);
+    EXPECT_TRUE(serial_frame_connected(&rx, 100 + SERIAL_TIMEOUT - 1));
+    EXPECT_FALSE(serial_frame_connected(&rx, 100 + SERIAL_TIMEOUT));
+}
+
+TEST_F(SerialFrame, TheFirstFrameAfterATimeoutIsAlwaysNew) {
+    serial_frame_update(frame, FRAME_SIZE, sent);
+    receive(0);
+    serial_frame_connected(&rx, SERIAL_TIMEOUT);
+    // the other half restarted, and happens to reuse the sequence number
+    received[0] = 0x55;
+    EXPECT_EQ(receive(SERIAL_TIMEOUT + 1), SERIAL_FRAME_NEW);
+    EXPECT_EQ(received[0], 0);
+}
+
+TEST_F(SerialFrame, TheTimeoutWorksAcrossTimerWraparound) {
+    serial_frame_update(frame, FRAME_SIZE, sent);
+    receive(0xFFF0);
+    EXPECT_TRUE(serial_frame_connected(&rx, 0x0010));
+}
+
+TEST_F(SerialFrame, AChangeIsSentRightAway) {
+    EXPECT_TRUE(serial_frame_send_due(true, false, true, 0));
+    EXPECT_FALSE(serial_frame_send_due(false, false, true, 0));
+}
+
+TEST_F(SerialFrame, AHeartbeatIsSentEveryInterval) {
+    EXPECT_FALSE(serial_frame_send_due(false, false, false, SERIAL_HEARTBEAT_INTERVAL - 1));
+    EXPECT_TRUE(serial_frame_send_due(false, false, false, SERIAL_HEARTBEAT_INTERVAL));
+}
+
+TEST_F(SerialFrame, TheHalvesBackOffDifferentlyAfterACollision) {
+    EXPECT_TRUE(serial_frame_send_due(true, true, true, 1));
+    EXPECT_FALSE(serial_frame_send_due(true, true, false, 1));
+    EXPECT_TRUE(serial_frame_send_due(true, true, false, 3));
+}
@@ -20,4 +20,7 @@
 #define MATRIX_ROWS 4
 #define MATRIX_COLS 10
 
+#define LAYER_CACHE_ENABLE
+#define PROCESS_RECORD_STATS
+
 #endif /* TESTS_BASIC_CONFIG_H_ */
@@ -13,4 +13,5 @@
 # You should have received a copy of the GNU General Public License
 # along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
-CUSTOM_MATRIX=yes
\ No newline at end of file
+CUSTOM_MATRIX=yes
+INSTRUMENT_ENABLE=yes
@@ -90,3 +90,62 @@ TEST_F(ActionLayer, LayerStateCmp) {
 //     layer_off(2);
 //     EXPECT_EQ(layer_state, 0b1000);
 // }
+
+TEST_F(ActionLayer, LayerCacheResolvesEachKeyOnlyOnce) {
+    TestDriver driver;
+    layer_cache_invalidate();
+    layer_cache_hits = 0;
+    layer_cache_misses = 0;
+
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    run_one_scan_loop();
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_EQ(layer_cache_misses, 1);
+    EXPECT_GT(layer_cache_hits, 0);
+
+    uint32_t hits = layer_cache_hits;
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    run_one_scan_loop();
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_EQ(layer_cache_misses, 1);
+    EXPECT_GT(layer_cache_hits, hits);
+}
+
+TEST_F(ActionLayer, LayerCacheIsRefilledWhenLayerStateChanges) {
+    TestDriver driver;
+    layer_cache_invalidate();
+    layer_cache_hits = 0;
+    layer_cache_misses = 0;
+
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    run_one_scan_loop();
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+    EXPECT_EQ(layer_cache_misses, 1);
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+    layer_on(0);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    run_one_scan_loop();
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+    EXPECT_EQ(layer_cache_misses, 2);
+}
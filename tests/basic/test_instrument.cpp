@@ -0,0 +1,55 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "instrument.h"
+}
+
+using testing::_;
+using testing::InSequence;
+
+class Instrument : public TestFixture {};
+
+TEST_F(Instrument, ScanRateIsPublishedEverySecond) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    // The first window may be partial, the second one is complete
+    idle_for(2500);
+    EXPECT_EQ(instrument_get_stats()->scan_rate, 1000);
+    EXPECT_EQ(instrument_get_stats()->ticks_per_ms, 1);
+}
+
+TEST_F(Instrument, KeyToReportLatencyIsRecorded) {
+    TestDriver driver;
+    InSequence s;
+
+    instrument_reset();
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    run_one_scan_loop();
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+
+    // The test timer only advances between scans
+    const instrument_stats_t *stats = instrument_get_stats();
+    EXPECT_EQ(stats->latency[0], 2);
+    for (int i = 1; i < INSTRUMENT_LATENCY_BUCKETS; i++) {
+        EXPECT_EQ(stats->latency[i], 0);
+    }
+}
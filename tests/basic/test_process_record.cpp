@@ -0,0 +1,38 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+using testing::_;
+
+class ProcessRecord : public TestFixture {};
+
+static keyrecord_t make_record(bool pressed) {
+    keyrecord_t record = {};
+    record.event.key = (keypos_t){ .col = 0, .row = 0 };
+    record.event.pressed = pressed;
+    record.event.time = 1;
+    return record;
+}
+
+TEST_F(ProcessRecord, PlainKeycodeOnlyReachesHandlersThatCoverIt) {
+    keyrecord_t record = make_record(true);
+    process_record_handler_calls = 0;
+    EXPECT_TRUE(process_record_handlers_dispatch(KC_A, &record));
+    // Only process_record_kb covers every keycode in this build, the leader
+    // handler is skipped while no sequence is active
+    EXPECT_EQ(process_record_handler_calls, 1);
+}
@@ -95,3 +95,42 @@ TEST_F(Tapping, ANewTapWithinTappingTermIsBuggy) {
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT))).Times(1);
     idle_for(TAPPING_TERM);
 }
+
+TEST_F(Tapping, RollingMoreKeysThanTheWaitingBufferHoldsSettlesTheHold) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(7, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    // Seven events fill the waiting buffer
+    uint8_t cols[] = {0, 1, 0, 1};
+    uint8_t rows[] = {0, 0, 3, 3};
+    for (int i = 0; i < 4; i++) {
+        press_key(cols[i], rows[i]);
+        run_one_scan_loop();
+        if (i < 3) {
+            release_key(cols[i], rows[i]);
+            run_one_scan_loop();
+        }
+    }
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // The next one doesn't fit, so the tap key is taken as held and the
+    // waiting keys are typed with it instead of being dropped
+    release_key(1, 3);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_B)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_C)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_D)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    run_one_scan_loop();
+
+    release_key(7, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
@@ -0,0 +1,64 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+
+// The traces in traces/ are recorded against this layout, don't rearrange keys
+
+enum layers {
+    _BASE,
+    _NUM,
+    _NAV,
+};
+
+#define HM_A SFT_T(KC_A)
+#define HM_F CTL_T(KC_F)
+#define HM_J CTL_T(KC_J)
+#define HM_SCLN SFT_T(KC_SCLN)
+#define NAV_BSPC LT(_NAV, KC_BSPC)
+
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [_BASE] = {
+        {KC_Q,  KC_W,  KC_E,  KC_R,     KC_T,   KC_Y,   KC_U,     KC_I,    KC_O,   KC_P},
+        {HM_A,  KC_S,  KC_D,  HM_F,     KC_G,   KC_H,   HM_J,     KC_K,    KC_L,   HM_SCLN},
+        {KC_Z,  KC_X,  KC_C,  KC_V,     KC_B,   KC_N,   KC_M,     KC_COMM, KC_DOT, KC_SLSH},
+        {KC_NO, KC_NO, KC_NO, MO(_NUM), KC_SPC, KC_ENT, NAV_BSPC, KC_NO,   KC_NO,  KC_NO},
+    },
+    [_NUM] = {
+        {KC_1,    KC_2,    KC_3,    KC_4,    KC_5,    KC_6,    KC_7,    KC_8,    KC_9,    KC_0},
+        {_______, _______, _______, _______, _______, KC_MINS, KC_EQL,  KC_LBRC, KC_RBRC, KC_BSLS},
+        {_______, _______, _______, _______, _______, _______, _______, _______, _______, _______},
+        {_______, _______, _______, _______, _______, _______, _______, _______, _______, _______},
+    },
+    [_NAV] = {
+        {KC_F1,   KC_F2,   KC_F3,   KC_F4,   KC_F5,   KC_HOME, KC_PGDN, KC_PGUP, KC_END,  KC_F6},
+        {_______, _______, _______, _______, _______, KC_LEFT, KC_DOWN, KC_UP,   KC_RGHT, _______},
+        {_______, _______, _______, _______, _______, _______, _______, _______, _______, _______},
+        {_______, _______, _______, _______, _______, _______, _______, _______, _______, _______},
+    },
+};
+
+const uint16_t PROGMEM we_combo[] = {KC_W, KC_E, COMBO_END};
+const uint16_t PROGMEM io_combo[] = {KC_I, KC_O, COMBO_END};
+const uint16_t PROGMEM mcomm_combo[] = {KC_M, KC_COMM, COMBO_END};
+const uint16_t PROGMEM xcv_combo[] = {KC_X, KC_C, KC_V, COMBO_END};
+
+combo_t key_combos[COMBO_COUNT] = {
+    COMBO(we_combo, KC_ESC),
+    COMBO(io_combo, KC_BSPC),
+    COMBO(mcomm_combo, KC_ENT),
+    COMBO(xcv_combo, LCTL(KC_V)),
+};
@@ -0,0 +1,72 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include "replay.hpp"
+#include <cstdlib>
+#include <iostream>
+
+class Benchmark : public TestFixture {};
+
+static std::vector<ReplayEvent> load_trace(const char* name) {
+    return Replay::load(std::string(REPLAY_TRACE_DIR) + "/" + name + ".trace");
+}
+
+// Replays a trace twice and checks that both runs send the same reports at the
+// same times, and that all keys are released at the end
+static ReplayResult replay_trace(const std::string& name, const std::vector<ReplayEvent>& events) {
+    ReplayResult first = Replay::run(events, TAPPING_TERM * 2);
+    ReplayResult second = Replay::run(events, TAPPING_TERM * 2);
+
+    EXPECT_EQ(first.reports.size(), second.reports.size());
+    for (size_t i = 0; i < std::min(first.reports.size(), second.reports.size()); i++) {
+        EXPECT_EQ(first.reports[i].time, second.reports[i].time) << "report " << i;
+        EXPECT_EQ(first.reports[i].report, second.reports[i].report) << "report " << i;
+    }
+    report_keyboard_t empty = {};
+    EXPECT_FALSE(first.reports.empty());
+    if (!first.reports.empty()) {
+        EXPECT_EQ(first.reports.back().report, empty);
+    }
+    Replay::print_summary(std::cout, name, first);
+    return first;
+}
+
+TEST_F(Benchmark, Typing) {
+    replay_trace("typing", load_trace("typing"));
+}
+
+TEST_F(Benchmark, Tapping) {
+    replay_trace("tapping", load_trace("tapping"));
+}
+
+TEST_F(Benchmark, Combos) {
+    replay_trace("combos", load_trace("combos"));
+}
+
+TEST_F(Benchmark, Layers) {
+    replay_trace("layers", load_trace("layers"));
+}
+
+// REPLAY_TRACE=<file> replays a trace of your own and prints its reports
+TEST_F(Benchmark, TraceFromEnvironment) {
+    const char* path = std::getenv("REPLAY_TRACE");
+    if (!path) {
+        return;
+    }
+    ReplayResult result = replay_trace(path, Replay::load(path));
+    Replay::print_reports(std::cout, result);
+}
@@ -0,0 +1,158 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+using testing::_;
+using testing::InSequence;
+
+class Combo : public TestFixture {};
+
+TEST_F(Combo, PressingAllKeysSendsTheCombo) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(3, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    press_key(4, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_Z)));
+    run_one_scan_loop();
+    release_key(3, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+    // The combo was already released with the first key
+    release_key(4, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, ComboActionCallsProcessComboEvent) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(6, 0);
+    press_key(7, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_4)));
+    run_one_scan_loop();
+    release_key(6, 0);
+    release_key(7, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, TappingAComboKeySendsTheKey) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(3, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    release_key(3, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_D)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, HoldingAComboKeySendsTheKeyAfterComboTerm) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(3, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    idle_for(COMBO_TERM);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_D)));
+    idle_for(2);
+    // The combo is not armed again until all its keys are released
+    press_key(4, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_D, KC_E)));
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, OtherKeySendsTheHeldBackKeyFirst) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(3, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    press_key(5, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_D)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_D, KC_F)));
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, LongestOverlappingComboWins) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(0, 0);
+    press_key(1, 0);
+    // A+B is down, but A+B+C can still complete
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    press_key(2, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_Y)));
+    run_one_scan_loop();
+    release_key(0, 0);
+    release_key(1, 0);
+    release_key(2, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, ShorterOverlappingComboIsSentOnRelease) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(0, 0);
+    press_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_X)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+    release_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, ShorterOverlappingComboIsSentAfterComboTerm) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(0, 0);
+    press_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    idle_for(COMBO_TERM);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_X)));
+    idle_for(2);
+}
+
+TEST_F(Combo, ShorterOverlappingComboIsSentBeforeOtherKey) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(0, 0);
+    press_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    press_key(5, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_X)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_X, KC_F)));
+    run_one_scan_loop();
+}
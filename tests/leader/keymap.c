@@ -0,0 +1,42 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {
+        // 0     1      2      3      4      5      6      7      8      9
+        {KC_LEAD, KC_A,  KC_B,  KC_C,  KC_D,  KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO,   KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO,   KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO,   KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+    },
+};
+
+const uint16_t PROGMEM a_sequence[] = {KC_A, LEADER_END};
+const uint16_t PROGMEM b_sequence[] = {KC_B, LEADER_END};
+const uint16_t PROGMEM bc_sequence[] = {KC_B, KC_C, LEADER_END};
+
+const uint16_t * const leader_sequences[LEADER_SEQUENCE_COUNT] PROGMEM = {
+    a_sequence,
+    b_sequence,
+    bc_sequence,
+};
+
+void process_leader_sequence(uint8_t index) {
+    register_code(KC_1 + index);
+    unregister_code(KC_1 + index);
+}
@@ -0,0 +1,117 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+using testing::_;
+using testing::InSequence;
+
+class Leader : public TestFixture {
+  protected:
+    void tap_key(uint8_t col, uint8_t row) {
+        press_key(col, row);
+        run_one_scan_loop();
+        release_key(col, row);
+        run_one_scan_loop();
+    }
+};
+
+TEST_F(Leader, AUniqueSequenceFiresWithoutWaiting) {
+    TestDriver driver;
+    InSequence s;
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    tap_key(0, 0);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    press_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_1)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+    EXPECT_FALSE(is_leader_active());
+    release_key(1, 0);
+    run_one_scan_loop();
+}
+
+TEST_F(Leader, AnAmbiguousSequenceFiresAtTheTimeout) {
+    TestDriver driver;
+    InSequence s;
+
+    tap_key(0, 0);
+    tap_key(2, 0);
+    EXPECT_TRUE(is_leader_active());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_2)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    idle_for(300);
+    EXPECT_FALSE(is_leader_active());
+}
+
+TEST_F(Leader, TheLongerSequenceFiresWhenCompleted) {
+    TestDriver driver;
+    InSequence s;
+
+    tap_key(0, 0);
+    tap_key(2, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_3)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    tap_key(3, 0);
+    EXPECT_FALSE(is_leader_active());
+}
+
+TEST_F(Leader, AKeyThatMatchesNoSequenceEndsTheLeader) {
+    TestDriver driver;
+    InSequence s;
+
+    tap_key(0, 0);
+    press_key(4, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    EXPECT_FALSE(is_leader_active());
+    testing::Mock::VerifyAndClearExpectations(&driver);
+    // The release isn't swallowed, nothing is pressed so it sends one empty
+    // report, the first one since the driver was set
+    release_key(4, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // The next key is typed normally
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_D)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    tap_key(4, 0);
+}
+
+TEST_F(Leader, KcNoInASequenceDoesNotMatchTheEndOfAShorterOne) {
+    TestDriver driver;
+    InSequence s;
+
+    tap_key(0, 0);
+    press_key(2, 0);
+    run_one_scan_loop();
+    // The release of B isn't swallowed, the first report since the driver
+    // was set
+    release_key(2, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // KC_NO is 0 like LEADER_END, so B then KC_NO is not the B sequence and
+    // matches nothing
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    tap_key(5, 0);
+    EXPECT_FALSE(is_leader_active());
+    idle_for(300);
+}
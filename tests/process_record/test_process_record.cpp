@@ -0,0 +1,57 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include <chrono>
+#include <iostream>
+
+// This build enables combo, tap dance, unicode, auto shift and key lock on top
+// of the default leader handler, so several handlers cover every keycode
+
+class ProcessRecord : public TestFixture {};
+
+static keyrecord_t make_record(bool pressed) {
+    keyrecord_t record = {};
+    record.event.key = (keypos_t){ .col = 0, .row = 0 };
+    record.event.pressed = pressed;
+    record.event.time = 1;
+    return record;
+}
+
+TEST_F(ProcessRecord, DispatchBenchmark) {
+    const uint32_t events = 100000;
+    const uint16_t keycodes[] = { KC_A, KC_LSFT, LSFT(KC_1), MO(1) };
+    keyrecord_t record = make_record(false);
+
+    process_record_handler_calls = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < events; i++) {
+        // None of the handlers consume these keycodes, so the old chain of
+        // process_* calls ran every one of them for each event
+        ASSERT_TRUE(process_record_handlers_dispatch(keycodes[i % 4], &record));
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+
+    double calls_per_event = (double)process_record_handler_calls / events;
+    std::cout << "[ BENCHMARK] handler calls per event: " << calls_per_event
+              << " (chain: " << (int)process_record_handler_count << ")"
+              << ", ns per event: " << (double)ns / events << std::endl;
+    // kb, tap dance, leader, combo, unicode and auto shift
+    EXPECT_EQ(process_record_handler_count, 6);
+    // Only kb, combo and auto shift cover every keycode
+    EXPECT_EQ(process_record_handler_calls, 3 * events);
+}
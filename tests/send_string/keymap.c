@@ -0,0 +1,58 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+
+enum custom_keycodes {
+    HELLO = SAFE_RANGE,
+    LONG_RAM,
+    CTRL_A,
+    CANCEL,
+};
+
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {
+        // 0    1      2         3       4       5      6      7      8      9
+        {KC_A,  HELLO, LONG_RAM, CTRL_A, CANCEL, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO, KC_NO, KC_NO,    KC_NO,  KC_NO,  KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO, KC_NO, KC_NO,    KC_NO,  KC_NO,  KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO, KC_NO, KC_NO,    KC_NO,  KC_NO,  KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+    },
+};
+
+bool process_record_user(uint16_t keycode, keyrecord_t *record) {
+    if (!record->event.pressed) {
+        return true;
+    }
+    switch (keycode) {
+        case HELLO:
+            send_string_P("Hi");
+            return false;
+        case LONG_RAM: {
+            // longer than SEND_STRING_QUEUE_SIZE
+            char str[] = "abcdefghijklmnopqrst";
+            send_string(str);
+            return false;
+        }
+        case CTRL_A:
+            send_string_P(SS_DOWN(X_LCTRL) "b");
+            return false;
+        case CANCEL:
+            send_string_cancel();
+            return false;
+    }
+    return true;
+}
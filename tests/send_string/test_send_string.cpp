@@ -0,0 +1,100 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include "time.h"
+
+using testing::_;
+using testing::InSequence;
+using testing::InvokeWithoutArgs;
+
+class SendString : public TestFixture {};
+
+#define AT_TIME(t) WillOnce(InvokeWithoutArgs([current_time]() {EXPECT_EQ(timer_elapsed32(current_time), t);}))
+
+TEST_F(SendString, TypesOneReportPerInterval) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(1, 0);
+    uint32_t current_time = timer_read32();
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    release_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_H)))
+        .AT_TIME(1);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()))
+        .AT_TIME(11);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_I)))
+        .AT_TIME(21);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()))
+        .AT_TIME(31);
+    idle_for(40);
+}
+
+TEST_F(SendString, KeysAreProcessedWhileTyping) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(1, 0);
+    run_one_scan_loop();
+    release_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_H)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    idle_for(12);
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    run_one_scan_loop();
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A, KC_I)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    idle_for(20);
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(SendString, StringsLongerThanTheQueueAreTypedInFull) {
+    TestDriver driver;
+    InSequence s;
+
+    for (uint8_t key = KC_A; key <= KC_T; key++) {
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(key)));
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    }
+    press_key(2, 0);
+    run_one_scan_loop();
+    release_key(2, 0);
+    idle_for(200);
+    EXPECT_FALSE(send_string_busy());
+}
+
+TEST_F(SendString, CancelReleasesHeldKeys) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(3, 0);
+    run_one_scan_loop();
+    release_key(3, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LCTRL)));
+    run_one_scan_loop();
+    press_key(4, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+    release_key(4, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    idle_for(30);
+    EXPECT_FALSE(send_string_busy());
+}
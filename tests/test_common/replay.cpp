@@ -0,0 +1,151 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "replay.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include "test_driver.hpp"
+#include "test_matrix.h"
+
+extern "C" {
+#include "keyboard.h"
+#include "timer.h"
+    void set_time(uint32_t t);
+    void advance_time(uint32_t ms);
+}
+
+using testing::_;
+using testing::AnyNumber;
+using testing::Invoke;
+
+std::vector<ReplayEvent> Replay::parse(std::istream& stream) {
+    std::vector<ReplayEvent> events;
+    std::string line;
+    unsigned line_number = 0;
+
+    while (std::getline(stream, line)) {
+        line_number++;
+        std::istringstream fields(line);
+        std::string first;
+        if (!(fields >> first) || first[0] == '#') {
+            continue;
+        }
+
+        unsigned long time;
+        unsigned row, col;
+        std::string state;
+        std::istringstream time_field(first);
+        if (!(time_field >> time) || !(fields >> row >> col >> state) ||
+            row >= MATRIX_ROWS || col >= MATRIX_COLS || (state != "d" && state != "u")) {
+            ADD_FAILURE() << "trace line " << line_number << ": " << line;
+            return {};
+        }
+        if (!events.empty() && time < events.back().time) {
+            ADD_FAILURE() << "trace line " << line_number << ": time goes backwards";
+            return {};
+        }
+        events.push_back({static_cast<uint32_t>(time), static_cast<uint8_t>(row),
+                          static_cast<uint8_t>(col), state == "d"});
+    }
+    return events;
+}
+
+std::vector<ReplayEvent> Replay::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        ADD_FAILURE() << "can't open trace " << path;
+        return {};
+    }
+    return parse(file);
+}
+
+ReplayResult Replay::run(const std::vector<ReplayEvent>& events, uint32_t tail) {
+    ReplayResult result;
+    std::vector<uint32_t> pending;
+    // Start at a multiple of 2^16 ms, so that every replay sees the same 16
+    // bit timer values and event time stamps
+    uint32_t start = (timer_read32() | 0xFFFF) + 1;
+    set_time(start);
+    uint32_t end = (events.empty() ? 0 : events.back().time) + tail;
+    size_t next = 0;
+
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_))
+        .Times(AnyNumber())
+        .WillRepeatedly(Invoke([&](report_keyboard_t& report) {
+            result.reports.push_back({timer_read32() - start, report});
+            for (uint32_t scan : pending) {
+                result.latency_scans.push_back(result.scans - scan);
+            }
+            pending.clear();
+        }));
+
+    for (uint32_t t = 0; t <= end; t++) {
+        bool applied = false;
+        for (; next < events.size() && events[next].time <= t; next++) {
+            const ReplayEvent& event = events[next];
+            if (event.pressed) {
+                press_key(event.col, event.row);
+            } else {
+                release_key(event.col, event.row);
+            }
+            pending.push_back(result.scans);
+            applied = true;
+        }
+
+        auto before = std::chrono::steady_clock::now();
+        keyboard_task();
+        auto after = std::chrono::steady_clock::now();
+        if (applied) {
+            result.event_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(after - before).count());
+        }
+        result.scans++;
+        advance_time(1);
+    }
+    testing::Mock::VerifyAndClearExpectations(&driver);
+    return result;
+}
+
+namespace {
+    template<typename T>
+    T percentile(std::vector<T> values, unsigned p) {
+        if (values.empty()) return 0;
+        std::sort(values.begin(), values.end());
+        return values[(values.size() - 1) * p / 100];
+    }
+}
+
+void Replay::print_reports(std::ostream& stream, const ReplayResult& result) {
+    for (const ReplayReport& report : result.reports) {
+        stream << report.time << " mods " << static_cast<unsigned>(report.report.mods) << " keys";
+        for (uint8_t key : report.report.keys) {
+            if (key) stream << " " << static_cast<unsigned>(key);
+        }
+        stream << "\n";
+    }
+}
+
+void Replay::print_summary(std::ostream& stream, const std::string& name, const ReplayResult& result) {
+    stream << "[ BENCHMARK] " << name << ": " << result.scans << " scans, "
+           << result.event_ns.size() << " event scans, " << result.reports.size() << " reports\n";
+    stream << "[ BENCHMARK] " << name << ": event scan cpu ns p50 " << percentile(result.event_ns, 50)
+           << " p99 " << percentile(result.event_ns, 99) << "\n";
+    stream << "[ BENCHMARK] " << name << ": event to report scans p50 " << percentile(result.latency_scans, 50)
+           << " p99 " << percentile(result.latency_scans, 99)
+           << " max " << percentile(result.latency_scans, 100) << "\n";
+}
@@ -0,0 +1,65 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+#include "report.h"
+
+// A key change of a recorded trace. Traces are text files with one event per
+// line: "<time in ms> <row> <col> <d|u>". Empty lines and lines starting with
+// '#' are ignored.
+struct ReplayEvent {
+    uint32_t time;
+    uint8_t row;
+    uint8_t col;
+    bool pressed;
+};
+
+struct ReplayReport {
+    uint32_t time;
+    report_keyboard_t report;
+};
+
+struct ReplayResult {
+    uint32_t scans = 0;
+    std::vector<ReplayReport> reports;
+    // Host CPU time of every keyboard_task() that applied an event
+    std::vector<uint64_t> event_ns;
+    // Scans from an event to the first report after it, one entry per event
+    // that was followed by a report
+    std::vector<uint32_t> latency_scans;
+};
+
+class Replay {
+public:
+    // A malformed trace fails the current test and returns no events
+    static std::vector<ReplayEvent> parse(std::istream& stream);
+    static std::vector<ReplayEvent> load(const std::string& path);
+
+    // Drives keyboard_task() once per simulated ms from the current test time
+    // until tail ms after the last event. Installs its own TestDriver to
+    // record the reports, so the caller must not have one alive.
+    static ReplayResult run(const std::vector<ReplayEvent>& events, uint32_t tail);
+
+    // Human readable summary: reports, per event CPU time and latency
+    static void print_summary(std::ostream& stream, const std::string& name, const ReplayResult& result);
+    // Every emitted report with its time relative to the start of the replay
+    static void print_reports(std::ostream& stream, const ReplayResult& result);
+};
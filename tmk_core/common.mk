@@ -80,6 +80,11 @@ ifeq ($(strip $(NKRO_ENABLE)), yes)
     TMK_COMMON_DEFS += -DNKRO_ENABLE
 endif
 
+ifeq ($(strip $(INSTRUMENT_ENABLE)), yes)
+    TMK_COMMON_SRC += $(COMMON_DIR)/instrument.c
+    TMK_COMMON_DEFS += -DINSTRUMENT_ENABLE
+endif
+
 ifeq ($(strip $(USB_6KRO_ENABLE)), yes)
     TMK_COMMON_DEFS += -DUSB_6KRO_ENABLE
 endif
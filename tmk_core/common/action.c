@@ -26,6 +26,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "action_macro.h"
 #include "action_util.h"
 #include "action.h"
+#include "instrument.h"
 #include "wait.h"
 
 #ifdef DEBUG_ACTION
@@ -51,6 +52,7 @@ int retro_tapping_counter = 0;
 void action_exec(keyevent_t event)
 {
     if (!IS_NOEVENT(event)) {
+        instrument_stage_begin(INSTRUMENT_STAGE_ACTION);
         dprint("\n---- action_exec: start -----\n");
         dprint("EVENT: "); debug_event(event); dprintln();
 #ifdef RETRO_TAPPING
@@ -93,6 +95,10 @@ void action_exec(keyevent_t event)
         dprint("processed: "); debug_record(record); dprintln();
     }
 #endif
+
+    if (!IS_NOEVENT(event)) {
+        instrument_stage_end(INSTRUMENT_STAGE_ACTION);
+    }
 }
 
 #ifdef SWAP_HANDS_ENABLE
@@ -1,4 +1,5 @@
 #include <stdint.h>
+#include <string.h>
 #include "keyboard.h"
 #include "action.h"
 #include "util.h"
@@ -284,17 +285,17 @@ action_t store_or_get_action(bool pressed, keypos_t key)
 }
 
 
-/** \brief Layer switch get layer
+#ifndef NO_ACTION_LAYER
+/** \brief Layer switch find layer
  *
- * FIXME: Needs docs
+ * Walks the given layer mask from the top and returns the first layer whose
+ * action for the key is not transparent.
  */
-int8_t layer_switch_get_layer(keypos_t key)
+static int8_t layer_switch_find_layer(keypos_t key, uint32_t layers)
 {
-#ifndef NO_ACTION_LAYER
     action_t action;
     action.code = ACTION_TRANSPARENT;
 
-    uint32_t layers = layer_state | default_layer_state;
     /* check top layer first */
     for (int8_t i = 31; i >= 0; i--) {
         if (layers & (1UL<<i)) {
@@ -306,6 +307,73 @@ int8_t layer_switch_get_layer(keypos_t key)
     }
     /* fall back to layer 0 */
     return 0;
+}
+#endif
+
+#if !defined(NO_ACTION_LAYER) && defined(LAYER_CACHE_ENABLE)
+#define LAYER_CACHE_EMPTY 0xFF
+
+/* Resolved layer per key, valid for the layer mask in layer_cache_state */
+static uint8_t layer_cache[MATRIX_ROWS][MATRIX_COLS];
+static uint32_t layer_cache_state = 0;
+static bool layer_cache_valid = false;
+
+uint32_t layer_cache_hits = 0;
+uint32_t layer_cache_misses = 0;
+
+/** \brief Layer cache invalidate
+ *
+ * Drops all resolved layers. Call this when the keymap itself changes at
+ * runtime; layer state changes are detected automatically.
+ */
+void layer_cache_invalidate(void)
+{
+    layer_cache_valid = false;
+}
+
+/** \brief Layer cache lookup
+ *
+ * Returns the resolved layer for the key, filling the entry on a miss. The
+ * whole table is emptied as soon as the active layer mask differs from the
+ * one it was filled for.
+ */
+static int8_t layer_cache_get_layer(keypos_t key, uint32_t layers)
+{
+    if (key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) {
+        return layer_switch_find_layer(key, layers);
+    }
+
+    if (!layer_cache_valid || layers != layer_cache_state) {
+        memset(layer_cache, LAYER_CACHE_EMPTY, sizeof(layer_cache));
+        layer_cache_state = layers;
+        layer_cache_valid = true;
+    }
+
+    uint8_t *entry = &layer_cache[key.row][key.col];
+    if (*entry == LAYER_CACHE_EMPTY) {
+        layer_cache_misses++;
+        *entry = layer_switch_find_layer(key, layers);
+    } else {
+        layer_cache_hits++;
+    }
+    return *entry;
+}
+#endif
+
+/** \brief Layer switch get layer
+ *
+ * Returns the topmost non-transparent layer for the key. With
+ * LAYER_CACHE_ENABLE the result is served from the effective layer cache.
+ */
+int8_t layer_switch_get_layer(keypos_t key)
+{
+#ifndef NO_ACTION_LAYER
+    uint32_t layers = layer_state | default_layer_state;
+#ifdef LAYER_CACHE_ENABLE
+    return layer_cache_get_layer(key, layers);
+#else
+    return layer_switch_find_layer(key, layers);
+#endif
 #else
     return biton32(default_layer_state);
 #endif
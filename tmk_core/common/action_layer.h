@@ -96,6 +96,15 @@ uint8_t read_source_layers_cache(keypos_t key);
 #endif
 action_t store_or_get_action(bool pressed, keypos_t key);
 
+/* effective layer cache */
+#if !defined(NO_ACTION_LAYER) && defined(LAYER_CACHE_ENABLE)
+extern uint32_t layer_cache_hits;
+extern uint32_t layer_cache_misses;
+void layer_cache_invalidate(void);
+#else
+#define layer_cache_invalidate()
+#endif
+
 /* return the topmost non-transparent layer currently associated with key */
 int8_t layer_switch_get_layer(keypos_t key);
 
@@ -21,13 +21,27 @@
 #define WITHIN_TAPPING_TERM(e)  (TIMER_DIFF_16(e.time, tapping_key.event.time) < TAPPING_TERM)
 
 
+#define WAITING_BUFFER_NEXT(i)  ((i) + 1 == WAITING_BUFFER_SIZE ? 0 : (i) + 1)
+
+/* Keys with a press waiting in the buffer, one bit per matrix position, so
+ * waiting_buffer_typed() doesn't have to search the buffer.
+ */
+#define WAITING_BUFFER_HAS_BIT(k)   ((k).row < MATRIX_ROWS && (k).col < MATRIX_COLS)
+#define WAITING_BUFFER_BIT(k)       ((k).row * MATRIX_COLS + (k).col)
+
+
 static keyrecord_t tapping_key = {};
 static keyrecord_t waiting_buffer[WAITING_BUFFER_SIZE] = {};
 static uint8_t waiting_buffer_head = 0;
 static uint8_t waiting_buffer_tail = 0;
+static uint8_t waiting_buffer_pressed[(MATRIX_ROWS * MATRIX_COLS + 7) / 8] = {};
+static uint8_t waiting_buffer_presses = 0;
 
 static bool process_tapping(keyrecord_t *record);
 static bool waiting_buffer_enq(keyrecord_t record);
+static void waiting_buffer_deq(void);
+static void waiting_buffer_process(void);
+static void waiting_buffer_settle(void);
 static void waiting_buffer_clear(void);
 static bool waiting_buffer_typed(keyevent_t event);
 static bool waiting_buffer_has_anykey_pressed(void);
@@ -48,11 +62,18 @@ void action_tapping_process(keyrecord_t record)
         }
     } else {
         if (!waiting_buffer_enq(record)) {
-            // clear all in case of overflow.
-            debug("OVERFLOW: CLEAR ALL STATES\n");
-            clear_keyboard();
-            waiting_buffer_clear();
-            tapping_key = (keyrecord_t){};
+            // settle the tap key as held, which makes room in the buffer
+            debug("OVERFLOW: SETTLE TAPPING KEY\n");
+            waiting_buffer_settle();
+            if (process_tapping(&record)) {
+                debug("processed: "); debug_record(record); debug("\n");
+            } else if (!waiting_buffer_enq(record)) {
+                // clear all in case it still doesn't fit.
+                debug("OVERFLOW: CLEAR ALL STATES\n");
+                clear_keyboard();
+                waiting_buffer_clear();
+                tapping_key = (keyrecord_t){};
+            }
         }
     }
 
@@ -60,14 +81,7 @@ void action_tapping_process(keyrecord_t record)
     if (!IS_NOEVENT(record.event) && waiting_buffer_head != waiting_buffer_tail) {
         debug("---- action_exec: process waiting_buffer -----\n");
     }
-    for (; waiting_buffer_tail != waiting_buffer_head; waiting_buffer_tail = (waiting_buffer_tail + 1) % WAITING_BUFFER_SIZE) {
-        if (process_tapping(&waiting_buffer[waiting_buffer_tail])) {
-            debug("processed: waiting_buffer["); debug_dec(waiting_buffer_tail); debug("] = ");
-            debug_record(waiting_buffer[waiting_buffer_tail]); debug("\n\n");
-        } else {
-            break;
-        }
-    }
+    waiting_buffer_process();
     if (!IS_NOEVENT(record.event)) {
         debug("\n");
     }
@@ -303,18 +317,79 @@ bool waiting_buffer_enq(keyrecord_t record)
         return true;
     }
 
-    if ((waiting_buffer_head + 1) % WAITING_BUFFER_SIZE == waiting_buffer_tail) {
+    if (WAITING_BUFFER_NEXT(waiting_buffer_head) == waiting_buffer_tail) {
         debug("waiting_buffer_enq: Over flow.\n");
         return false;
     }
 
     waiting_buffer[waiting_buffer_head] = record;
-    waiting_buffer_head = (waiting_buffer_head + 1) % WAITING_BUFFER_SIZE;
+    waiting_buffer_head = WAITING_BUFFER_NEXT(waiting_buffer_head);
+
+    if (record.event.pressed) {
+        waiting_buffer_presses++;
+        if (WAITING_BUFFER_HAS_BIT(record.event.key)) {
+            uint16_t bit = WAITING_BUFFER_BIT(record.event.key);
+            waiting_buffer_pressed[bit / 8] |= 1 << (bit % 8);
+        }
+    }
 
     debug("waiting_buffer_enq: "); debug_waiting_buffer();
     return true;
 }
 
+/** \brief Waiting buffer deq
+ *
+ * Drops the oldest event, which has been processed.
+ */
+void waiting_buffer_deq(void)
+{
+    keyevent_t event = waiting_buffer[waiting_buffer_tail].event;
+    waiting_buffer_tail = WAITING_BUFFER_NEXT(waiting_buffer_tail);
+
+    if (!event.pressed) return;
+    waiting_buffer_presses--;
+    if (!WAITING_BUFFER_HAS_BIT(event.key)) return;
+
+    // the key may have been pressed again while its first press waited
+    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = WAITING_BUFFER_NEXT(i)) {
+        if (waiting_buffer[i].event.pressed && KEYEQ(event.key, waiting_buffer[i].event.key)) return;
+    }
+    uint16_t bit = WAITING_BUFFER_BIT(event.key);
+    waiting_buffer_pressed[bit / 8] &= ~(1 << (bit % 8));
+}
+
+/** \brief Waiting buffer process
+ *
+ * Processes the waiting events in order until one has to wait again.
+ */
+void waiting_buffer_process(void)
+{
+    while (waiting_buffer_tail != waiting_buffer_head) {
+        if (!process_tapping(&waiting_buffer[waiting_buffer_tail])) break;
+
+        debug("processed: waiting_buffer["); debug_dec(waiting_buffer_tail); debug("] = ");
+        debug_record(waiting_buffer[waiting_buffer_tail]); debug("\n\n");
+        waiting_buffer_deq();
+    }
+}
+
+/** \brief Waiting buffer settle
+ *
+ * Called when the buffer is full. The undecided tap key is taken as held,
+ * like at the end of TAPPING_TERM, and the waiting events are processed.
+ * No event is lost, at worst a roll is typed with the modifier or layer.
+ */
+void waiting_buffer_settle(void)
+{
+    if (IS_TAPPING_PRESSED() && tapping_key.tap.count == 0) {
+        debug("Tapping: End. Overflow. Not tap(0).\n");
+        process_record(&tapping_key);
+    }
+    tapping_key = (keyrecord_t){};
+    debug_tapping_key();
+    waiting_buffer_process();
+}
+
 /** \brief Waiting buffer clear
  *
  * FIXME: Needs docs
@@ -323,20 +398,28 @@ void waiting_buffer_clear(void)
 {
     waiting_buffer_head = 0;
     waiting_buffer_tail = 0;
+    waiting_buffer_presses = 0;
+    for (uint8_t i = 0; i < sizeof(waiting_buffer_pressed); i++) {
+        waiting_buffer_pressed[i] = 0;
+    }
 }
 
 /** \brief Waiting buffer typed
  *
- * FIXME: Needs docs
+ * Whether the key of a release event has a press waiting in the buffer.
  */
 bool waiting_buffer_typed(keyevent_t event)
 {
-    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
-        if (KEYEQ(event.key, waiting_buffer[i].event.key) && event.pressed !=  waiting_buffer[i].event.pressed) {
-            return true;
+    if (event.pressed || !WAITING_BUFFER_HAS_BIT(event.key)) {
+        for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = WAITING_BUFFER_NEXT(i)) {
+            if (KEYEQ(event.key, waiting_buffer[i].event.key) && event.pressed !=  waiting_buffer[i].event.pressed) {
+                return true;
+            }
         }
+        return false;
     }
-    return false;
+    uint16_t bit = WAITING_BUFFER_BIT(event.key);
+    return waiting_buffer_pressed[bit / 8] & (1 << (bit % 8));
 }
 
 /** \brief Waiting buffer has anykey pressed
@@ -346,10 +429,7 @@ bool waiting_buffer_typed(keyevent_t event)
 __attribute__((unused))
 bool waiting_buffer_has_anykey_pressed(void)
 {
-    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
-        if (waiting_buffer[i].event.pressed) return true;
-    }
-    return false;
+    return waiting_buffer_presses;
 }
 
 /** \brief Scan buffer for tapping
@@ -363,7 +443,7 @@ void waiting_buffer_scan_tap(void)
     // invalid state: tapping_key released && tap.count == 0
     if (!tapping_key.event.pressed) return;
 
-    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
+    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = WAITING_BUFFER_NEXT(i)) {
         if (IS_TAPPING_KEY(waiting_buffer[i].event.key) &&
                 !waiting_buffer[i].event.pressed &&
                 WITHIN_TAPPING_TERM(waiting_buffer[i].event)) {
@@ -395,7 +475,7 @@ static void debug_tapping_key(void)
 static void debug_waiting_buffer(void)
 {
     debug("{ ");
-    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
+    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = WAITING_BUFFER_NEXT(i)) {
         debug("["); debug_dec(i); debug("]="); debug_record(waiting_buffer[i]); debug(" ");
     }
     debug("}\n");
@@ -35,6 +35,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "backlight.h"
 #include "quantum.h"
 #include "version.h"
+#include "instrument.h"
 
 #ifdef MOUSEKEY_ENABLE
 #include "mousekey.h"
@@ -170,6 +171,10 @@ static void command_common_help(void)
 #ifdef SLEEP_LED_ENABLE
 		STR(MAGIC_KEY_SLEEP_LED   ) ":	Sleep LED Test\n"
 #endif
+
+#ifdef INSTRUMENT_ENABLE
+		STR(MAGIC_KEY_INSTRUMENT  ) ":	Print Scan Rate and Latency\n"
+#endif
     );
 }
 
@@ -322,6 +327,15 @@ static bool command_common(uint8_t code)
             break;
 #endif
 
+#ifdef INSTRUMENT_ENABLE
+
+		// print scan rate and latency statistics
+        case MAGIC_KC(MAGIC_KEY_INSTRUMENT):
+            print("\n\t- Instrumentation -\n");
+            instrument_print();
+            break;
+#endif
+
 #ifdef BOOTMAGIC_ENABLE
 
 		// print stored eeprom config
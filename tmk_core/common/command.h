@@ -153,6 +153,10 @@ bool command_proc(uint8_t code);
 
 #endif
 
+#ifndef MAGIC_KEY_INSTRUMENT
+#define MAGIC_KEY_INSTRUMENT     I
+#endif
+
 #define XMAGIC_KC(key) KC_##key
 #define MAGIC_KC(key) XMAGIC_KC(key)
 
@@ -16,20 +16,40 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include <stdint.h>
+#include <string.h>
 //#include <avr/interrupt.h>
 #include "keycode.h"
 #include "host.h"
 #include "util.h"
 #include "debug.h"
+#include "instrument.h"
 
 static host_driver_t *driver;
 static uint16_t last_system_report = 0;
 static uint16_t last_consumer_report = 0;
 
+/* The last reports handed to the driver. A report equal to the last one
+ * carries no change for the host, so it isn't sent again.
+ */
+static report_keyboard_t last_keyboard_report;
+static bool last_keyboard_report_valid = false;
+static report_mouse_t last_mouse_report;
+static bool last_mouse_report_valid = false;
+
 
 void host_set_driver(host_driver_t *d)
 {
     driver = d;
+    host_forget_last_reports();
+}
+
+/* The next report of each kind is sent even if it didn't change, e.g. when the
+ * host may have lost the previous ones.
+ */
+void host_forget_last_reports(void)
+{
+    last_keyboard_report_valid = false;
+    last_mouse_report_valid = false;
 }
 
 host_driver_t *host_get_driver(void)
@@ -46,7 +66,15 @@ uint8_t host_keyboard_leds(void)
 void host_keyboard_send(report_keyboard_t *report)
 {
     if (!driver) return;
+    if (last_keyboard_report_valid &&
+        !memcmp(&last_keyboard_report, report, sizeof(report_keyboard_t))) return;
+    last_keyboard_report = *report;
+    last_keyboard_report_valid = true;
+
+    instrument_stage_begin(INSTRUMENT_STAGE_SEND);
     (*driver->send_keyboard)(report);
+    instrument_stage_end(INSTRUMENT_STAGE_SEND);
+    instrument_report_sent();
 
     if (debug_keyboard) {
         dprint("keyboard_report: ");
@@ -60,6 +88,12 @@ void host_keyboard_send(report_keyboard_t *report)
 void host_mouse_send(report_mouse_t *report)
 {
     if (!driver) return;
+    /* movement is relative, so only a report without any is a repeat */
+    bool still = !report->x && !report->y && !report->v && !report->h;
+    if (still && last_mouse_report_valid &&
+        !memcmp(&last_mouse_report, report, sizeof(report_mouse_t))) return;
+    last_mouse_report = *report;
+    last_mouse_report_valid = true;
     (*driver->send_mouse)(report);
 }
 
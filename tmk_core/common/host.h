@@ -35,6 +35,7 @@ extern uint8_t keyboard_protocol;
 /* host driver */
 void host_set_driver(host_driver_t *driver);
 host_driver_t *host_get_driver(void);
+void host_forget_last_reports(void);
 
 /* host driver interface */
 uint8_t host_keyboard_leds(void);
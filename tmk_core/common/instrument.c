@@ -0,0 +1,222 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "instrument.h"
+#include "timer.h"
+#include "print.h"
+#ifdef RAW_ENABLE
+#   include "raw_hid.h"
+#endif
+
+#if defined(__AVR__)
+#   include <avr/io.h>
+#   include <util/atomic.h>
+#   include "avr/timer_avr.h"
+#   define INSTRUMENT_TICKS_PER_MS (TIMER_RAW_TOP + 1)
+
+extern volatile uint32_t timer_count;
+
+static uint32_t instrument_ticks(void)
+{
+    uint32_t count;
+    uint8_t raw;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        count = timer_count;
+        raw = TIMER_RAW;
+#ifndef __AVR_ATmega32A__
+        if (TIFR0 & _BV(OCF0A)) {
+#else
+        if (TIFR & _BV(OCF0)) {
+#endif
+            // the counter wrapped but the interrupt has not run yet
+            raw = TIMER_RAW;
+            count++;
+        }
+    }
+    return count * INSTRUMENT_TICKS_PER_MS + raw;
+}
+#elif defined(PROTOCOL_CHIBIOS)
+#   include "ch.h"
+#   define INSTRUMENT_TICKS_PER_MS (CH_CFG_ST_FREQUENCY / 1000)
+#   if CH_CFG_ST_RESOLUTION < 32
+#       define INSTRUMENT_TICKS_MASK ((1UL << CH_CFG_ST_RESOLUTION) - 1)
+#   endif
+
+static uint32_t instrument_ticks(void)
+{
+    return chVTGetSystemTimeX();
+}
+#else
+#   define INSTRUMENT_TICKS_PER_MS 1
+
+static uint32_t instrument_ticks(void)
+{
+    return timer_read32();
+}
+#endif
+
+#if INSTRUMENT_TICKS_PER_MS < 1
+#   error "The instrumentation timer runs slower than 1 tick per ms"
+#endif
+
+#ifndef INSTRUMENT_TICKS_MASK
+#   define INSTRUMENT_TICKS_MASK 0xFFFFFFFF
+#endif
+
+#define TICKS_BETWEEN(start, end) (((end) - (start)) & INSTRUMENT_TICKS_MASK)
+
+static instrument_stats_t stats = { .ticks_per_ms = INSTRUMENT_TICKS_PER_MS };
+
+static uint32_t second_start;
+static uint32_t scan_start;
+static uint32_t scans;
+
+static uint32_t stage_start[INSTRUMENT_STAGE_COUNT];
+static uint32_t stage_total[INSTRUMENT_STAGE_COUNT];
+static uint16_t stage_calls[INSTRUMENT_STAGE_COUNT];
+
+static bool event_pending = false;
+static uint32_t event_start;
+
+/** \brief Counts a scan, called at the start of every keyboard_task()
+ *
+ * Publishes the scan rate and the stage averages once per second.
+ */
+void instrument_scan(void)
+{
+    uint32_t now = instrument_ticks();
+
+    scan_start = now;
+    scans++;
+    if (TICKS_BETWEEN(second_start, now) < 1000UL * INSTRUMENT_TICKS_PER_MS) return;
+
+    stats.scan_rate = scans;
+    for (uint8_t i = 0; i < INSTRUMENT_STAGE_COUNT; i++) {
+        uint32_t average = stage_calls[i] ? stage_total[i] / stage_calls[i] : 0;
+        stats.stage_ticks[i] = average > UINT16_MAX ? UINT16_MAX : average;
+        stage_total[i] = 0;
+        stage_calls[i] = 0;
+    }
+    scans = 0;
+    second_start = now;
+}
+
+/** \brief Starts a latency measurement at the current scan, if none is running */
+void instrument_key_event(void)
+{
+    if (event_pending) return;
+    event_pending = true;
+    event_start = scan_start;
+}
+
+/** \brief Ends the latency measurement of the last key event */
+void instrument_report_sent(void)
+{
+    if (!event_pending) return;
+    event_pending = false;
+
+    uint32_t latency = TICKS_BETWEEN(event_start, instrument_ticks());
+    if (latency > UINT32_MAX / 4) latency = UINT32_MAX / 4;
+
+    // bucket n: latency < 250us << n
+    uint8_t bucket = 0;
+    while (bucket < INSTRUMENT_LATENCY_BUCKETS - 1 &&
+           latency * 4 >= ((uint32_t)INSTRUMENT_TICKS_PER_MS << bucket)) {
+        bucket++;
+    }
+    if (stats.latency[bucket] < UINT16_MAX) stats.latency[bucket]++;
+}
+
+void instrument_stage_begin(instrument_stage_t stage)
+{
+    stage_start[stage] = instrument_ticks();
+}
+
+void instrument_stage_end(instrument_stage_t stage)
+{
+    stage_total[stage] += TICKS_BETWEEN(stage_start[stage], instrument_ticks());
+    if (stage_calls[stage] < UINT16_MAX) stage_calls[stage]++;
+}
+
+const instrument_stats_t *instrument_get_stats(void)
+{
+    return &stats;
+}
+
+void instrument_reset(void)
+{
+    memset(stats.latency, 0, sizeof(stats.latency));
+    event_pending = false;
+}
+
+void instrument_print(void)
+{
+    xprintf("scan rate: %lu/s\n", (unsigned long)stats.scan_rate);
+    xprintf("ticks/ms: %u\n", stats.ticks_per_ms);
+    xprintf("scan: %u action: %u send: %u ticks\n",
+            stats.stage_ticks[INSTRUMENT_STAGE_SCAN],
+            stats.stage_ticks[INSTRUMENT_STAGE_ACTION],
+            stats.stage_ticks[INSTRUMENT_STAGE_SEND]);
+    print("latency (<250us << n):");
+    for (uint8_t i = 0; i < INSTRUMENT_LATENCY_BUCKETS; i++) {
+        xprintf(" %u", stats.latency[i]);
+    }
+    print("\n");
+}
+
+#ifdef RAW_ENABLE
+static uint8_t *put16(uint8_t *p, uint16_t v)
+{
+    *p++ = v & 0xFF;
+    *p++ = v >> 8;
+    return p;
+}
+
+/** \brief Raw HID readout
+ *
+ * The reply reuses the request buffer, all values little endian:
+ *   [0]      INSTRUMENT_RAW_HID_ID
+ *   [1]      INSTRUMENT_STAGE_COUNT
+ *   [2..5]   scan rate
+ *   [6..7]   ticks per ms
+ *   [8..]    average ticks of each stage
+ *   then     the latency histogram
+ */
+bool instrument_raw_hid_receive(uint8_t *data, uint8_t length)
+{
+    if (length < 8 + 2 * (INSTRUMENT_STAGE_COUNT + INSTRUMENT_LATENCY_BUCKETS) ||
+        data[0] != INSTRUMENT_RAW_HID_ID) {
+        return false;
+    }
+
+    uint8_t *p = &data[1];
+    *p++ = INSTRUMENT_STAGE_COUNT;
+    p = put16(p, stats.scan_rate & 0xFFFF);
+    p = put16(p, stats.scan_rate >> 16);
+    p = put16(p, stats.ticks_per_ms);
+    for (uint8_t i = 0; i < INSTRUMENT_STAGE_COUNT; i++) {
+        p = put16(p, stats.stage_ticks[i]);
+    }
+    for (uint8_t i = 0; i < INSTRUMENT_LATENCY_BUCKETS; i++) {
+        p = put16(p, stats.latency[i]);
+    }
+    memset(p, 0, length - (p - data));
+    raw_hid_send(data, length);
+    return true;
+}
+#endif
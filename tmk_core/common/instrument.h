@@ -0,0 +1,84 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Scan rate and event latency instrumentation, enabled with
+ * INSTRUMENT_ENABLE = yes in rules.mk.
+ *
+ * Stage times are measured in ticks of a free running counter:
+ *   AVR:     Timer0, TIMER_PRESCALER CPU cycles per tick
+ *   ChibiOS: the system timer, CH_CFG_ST_FREQUENCY ticks per second
+ * instrument_stats_t.ticks_per_ms converts them to time.
+ */
+
+typedef enum {
+    INSTRUMENT_STAGE_SCAN,      // matrix_scan()
+    INSTRUMENT_STAGE_ACTION,    // action_exec() of a key event, includes SEND
+    INSTRUMENT_STAGE_SEND,      // host driver send_keyboard
+    INSTRUMENT_STAGE_COUNT
+} instrument_stage_t;
+
+/* Latency from the scan that saw a key change to the keyboard report it
+ * caused. Bucket n counts latencies below 250us << n, the last one the rest.
+ */
+#define INSTRUMENT_LATENCY_BUCKETS 8
+
+/* First byte of a raw HID request for the statistics */
+#ifndef INSTRUMENT_RAW_HID_ID
+#define INSTRUMENT_RAW_HID_ID 0xF7
+#endif
+
+typedef struct {
+    uint32_t scan_rate;                                 // scans in the last second
+    uint16_t ticks_per_ms;
+    uint16_t stage_ticks[INSTRUMENT_STAGE_COUNT];       // average per call in the last second
+    uint16_t latency[INSTRUMENT_LATENCY_BUCKETS];       // since boot or instrument_reset()
+} instrument_stats_t;
+
+#ifdef INSTRUMENT_ENABLE
+
+void instrument_scan(void);
+void instrument_key_event(void);
+void instrument_report_sent(void);
+void instrument_stage_begin(instrument_stage_t stage);
+void instrument_stage_end(instrument_stage_t stage);
+
+const instrument_stats_t *instrument_get_stats(void);
+void instrument_reset(void);
+void instrument_print(void);
+#ifdef RAW_ENABLE
+/* Answers an INSTRUMENT_RAW_HID_ID request with raw_hid_send(), returns
+ * false for any other request.
+ */
+bool instrument_raw_hid_receive(uint8_t *data, uint8_t length);
+#endif
+
+#else
+
+#define instrument_scan()                   do {} while (0)
+#define instrument_key_event()              do {} while (0)
+#define instrument_report_sent()            do {} while (0)
+#define instrument_stage_begin(stage)       do {} while (0)
+#define instrument_stage_end(stage)         do {} while (0)
+
+#endif
+
+#endif
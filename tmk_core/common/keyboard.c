@@ -31,6 +31,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "eeconfig.h"
 #include "backlight.h"
 #include "action_layer.h"
+#include "instrument.h"
 #ifdef BOOTMAGIC_ENABLE
 #   include "bootmagic.h"
 #else
@@ -183,6 +184,69 @@ void keyboard_init(void) {
 #endif
 }
 
+/* Maximum number of key changes handed to action_exec per scan. Changes
+ * beyond this stay in the matrix and are picked up by the next scan.
+ */
+#ifndef QMK_KEYS_PER_SCAN
+#   define QMK_KEYS_PER_SCAN 8
+#endif
+
+static matrix_row_t matrix_prev[MATRIX_ROWS];
+
+/** \brief Index of the lowest set bit of a matrix row
+ *
+ * rowdata must not be zero.
+ */
+static inline uint8_t matrix_row_ctz(matrix_row_t rowdata)
+{
+    if (sizeof(matrix_row_t) > sizeof(unsigned int)) {
+        return __builtin_ctzl(rowdata);
+    }
+    return __builtin_ctz(rowdata);
+}
+
+/** \brief Collect matrix changes
+ *
+ * Compares the matrix against the last processed state in a single pass and
+ * fills changes with up to max key events, all stamped with the time the
+ * matrix was sampled. Collected keys are marked as processed.
+ *
+ * Returns the number of events written.
+ */
+static uint8_t matrix_collect_changes(keyevent_t *changes, uint8_t max, uint16_t time)
+{
+    uint8_t count = 0;
+
+    for (uint8_t r = 0; r < MATRIX_ROWS && count < max; r++) {
+        matrix_row_t matrix_row = matrix_get_row(r);
+        matrix_row_t matrix_change = matrix_row ^ matrix_prev[r];
+        if (!matrix_change) {
+            continue;
+        }
+#ifdef MATRIX_HAS_GHOST
+        if (has_ghost_in_row(r, matrix_row)) {
+            /* Don't update matrix_prev until un-ghosted, or the last key
+             * would be lost.
+             */
+            continue;
+        }
+#endif
+        while (matrix_change && count < max) {
+            uint8_t c = matrix_row_ctz(matrix_change);
+            matrix_row_t col_mask = (matrix_row_t)1 << c;
+            changes[count++] = (keyevent_t){
+                .key = (keypos_t){ .row = r, .col = c },
+                .pressed = (matrix_row & col_mask),
+                .time = time
+            };
+            // record a processed key
+            matrix_prev[r] ^= col_mask;
+            matrix_change &= matrix_change - 1;
+        }
+    }
+    return count;
+}
+
 /** \brief Keyboard task: Do keyboard routine jobs
  *
  * Do routine keyboard jobs: 
@@ -197,66 +261,29 @@ void keyboard_init(void) {
  */
 void keyboard_task(void)
 {
-    static matrix_row_t matrix_prev[MATRIX_ROWS];
-#ifdef MATRIX_HAS_GHOST
-  //  static matrix_row_t matrix_ghost[MATRIX_ROWS];
-#endif
     static uint8_t led_status = 0;
-    matrix_row_t matrix_row = 0;
-    matrix_row_t matrix_change = 0;
-#ifdef QMK_KEYS_PER_SCAN
-    uint8_t keys_processed = 0;
-#endif
+    keyevent_t changes[QMK_KEYS_PER_SCAN];
+    uint8_t change_count = 0;
 
+    instrument_scan();
+    instrument_stage_begin(INSTRUMENT_STAGE_SCAN);
     matrix_scan();
+    instrument_stage_end(INSTRUMENT_STAGE_SCAN);
     if (is_keyboard_master()) {
-        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
-            matrix_row = matrix_get_row(r);
-            matrix_change = matrix_row ^ matrix_prev[r];
-            if (matrix_change) {
-#ifdef MATRIX_HAS_GHOST
-                if (has_ghost_in_row(r, matrix_row)) {
-                    /* Keep track of whether ghosted status has changed for
-                    * debugging. But don't update matrix_prev until un-ghosted, or
-                    * the last key would be lost.
-                    */
-                    //if (debug_matrix && matrix_ghost[r] != matrix_row) {
-                    //    matrix_print();
-                    //}
-                    //matrix_ghost[r] = matrix_row;
-                    continue;
-                }
-                //matrix_ghost[r] = matrix_row;
-#endif
-                if (debug_matrix) matrix_print();
-                for (uint8_t c = 0; c < MATRIX_COLS; c++) {
-                    if (matrix_change & ((matrix_row_t)1<<c)) {
-                        action_exec((keyevent_t){
-                            .key = (keypos_t){ .row = r, .col = c },
-                            .pressed = (matrix_row & ((matrix_row_t)1<<c)),
-                            .time = (timer_read() | 1) /* time should not be 0 */
-                        });
-                        // record a processed key
-                        matrix_prev[r] ^= ((matrix_row_t)1<<c);
-#ifdef QMK_KEYS_PER_SCAN
-                        // only jump out if we have processed "enough" keys.
-                        if (++keys_processed >= QMK_KEYS_PER_SCAN)
-#endif
-                        // process a key per task call
-                        goto MATRIX_LOOP_END;
-                    }
-                }
-            }
+        /* time should not be 0 */
+        change_count = matrix_collect_changes(changes, QMK_KEYS_PER_SCAN, timer_read() | 1);
+        if (change_count) {
+            instrument_key_event();
+            if (debug_matrix) matrix_print();
+        }
+        for (uint8_t i = 0; i < change_count; i++) {
+            action_exec(changes[i]);
         }
     }
     // call with pseudo tick event when no real key event.
-#ifdef QMK_KEYS_PER_SCAN
-    // we can get here with some keys processed now.
-    if (!keys_processed)
-#endif
-    action_exec(TICK);
-
-MATRIX_LOOP_END:
+    if (!change_count) {
+        action_exec(TICK);
+    }
 
 #ifdef MOUSEKEY_ENABLE
     // mousekey repeat & acceleration
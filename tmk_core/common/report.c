@@ -14,20 +14,60 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
 #include "report.h"
 #include "host.h"
 #include "keycode_config.h"
 #include "debug.h"
 #include "util.h"
 
+#ifdef USB_6KRO_ENABLE
+/* The keys are a ring buffer, in the order they were pressed. The indexes
+ * wrap with a compare instead of a modulo, which is a division on AVR.
+ */
+#define RO_INC(a) ((a) + 1 == KEYBOARD_REPORT_KEYS ? 0 : (a) + 1)
+#define RO_DEC(a) ((a) == 0 ? KEYBOARD_REPORT_KEYS - 1 : (a) - 1)
+#define RO_SUB(a, b) ((a) >= (b) ? (a) - (b) : (a) + KEYBOARD_REPORT_KEYS - (b))
+static int8_t cb_head = 0;
+static int8_t cb_tail = 0;
+static int8_t cb_count = 0;
+#endif
+
+/* 32 bit targets skip empty parts of the report a word at a time. The report
+ * is packed, so the words are copied out rather than read in place.
+ */
+#ifndef __AVR__
+#define REPORT_WORD_SCAN
+#endif
+
+#ifdef REPORT_WORD_SCAN
+static inline uint32_t report_word(const uint8_t *bytes)
+{
+    uint32_t word;
+    memcpy(&word, bytes, sizeof(word));
+    return word;
+}
+#endif
+
 /** \brief has_anykey
  *
- * FIXME: Needs doc
+ * Returns the number of key bytes in use, or of bitmap bytes with a key in NKRO mode.
  */
 uint8_t has_anykey(report_keyboard_t* keyboard_report)
 {
     uint8_t cnt = 0;
-    for (uint8_t i = 1; i < KEYBOARD_REPORT_SIZE; i++) {
+    uint8_t i = 1;
+#ifdef REPORT_WORD_SCAN
+    for (; i + 4 <= KEYBOARD_REPORT_SIZE; i += 4) {
+        if (!report_word(&keyboard_report->raw[i]))
+            continue;
+        for (uint8_t j = i; j < i + 4; j++) {
+            if (keyboard_report->raw[j])
+                cnt++;
+        }
+    }
+#endif
+    for (; i < KEYBOARD_REPORT_SIZE; i++) {
         if (keyboard_report->raw[i])
             cnt++;
     }
@@ -43,8 +83,14 @@ uint8_t get_first_key(report_keyboard_t* keyboard_report)
 #ifdef NKRO_ENABLE
     if (keyboard_protocol && keymap_config.nkro) {
         uint8_t i = 0;
+#ifdef REPORT_WORD_SCAN
+        for (; i + 4 <= KEYBOARD_REPORT_BITS && !report_word(&keyboard_report->nkro.bits[i]); i += 4)
+            ;
+#endif
         for (; i < KEYBOARD_REPORT_BITS && !keyboard_report->nkro.bits[i]; i++)
             ;
+        if (i == KEYBOARD_REPORT_BITS)
+            return 0;
         return i<<3 | biton(keyboard_report->nkro.bits[i]);
     }
 #endif
@@ -240,4 +286,7 @@ void clear_keys_from_report(report_keyboard_t* keyboard_report)
     for (int8_t i = 1; i < KEYBOARD_REPORT_SIZE; i++) {
         keyboard_report->raw[i] = 0;
     }
+#ifdef USB_6KRO_ENABLE
+    cb_head = cb_tail = cb_count = 0;
+#endif
 }
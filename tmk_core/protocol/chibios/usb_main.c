@@ -29,6 +29,9 @@
 #endif
 #include "wait.h"
 #include "usb_descriptor.h"
+#ifdef INSTRUMENT_ENABLE
+#include "instrument.h"
+#endif
 #include "usb_driver.h"
 
 #ifdef NKRO_ENABLE
@@ -328,6 +331,8 @@ static void usb_event_cb(USBDriver *usbp, usbevent_t event) {
       qmkusbConfigureHookI(&drivers.array[i].driver);
     }
     osalSysUnlockFromISR();
+    /* The host has to be told the current state again, even if unchanged */
+    host_forget_last_reports();
     return;
   case USB_EVENT_SUSPEND:
 #ifdef SLEEP_LED_ENABLE
@@ -839,6 +844,9 @@ void raw_hid_receive( uint8_t *data, uint8_t length ) {
 	// Users should #include "raw_hid.h" in their own code
 	// and implement this function there. Leave this as weak linkage
 	// so users can opt to not handle data coming in.
+#ifdef INSTRUMENT_ENABLE
+	instrument_raw_hid_receive(data, length);
+#endif
 }
 
 void raw_hid_task(void) {
@@ -15,6 +15,7 @@ else
 endif
 
 LUFA_SRC = lufa.c \
+	   report_queue.c \
 	   usb_descriptor.c \
 	   outputselect.c \
 	   $(LUFA_SRC_USB)
@@ -54,6 +54,7 @@
 #include "quantum.h"
 #include <util/atomic.h>
 #include "outputselect.h"
+#include "report_queue.h"
 
 #ifdef NKRO_ENABLE
   #include "keycode_config.h"
@@ -90,6 +91,10 @@
 	#include "raw_hid.h"
 #endif
 
+#ifdef INSTRUMENT_ENABLE
+	#include "instrument.h"
+#endif
+
 uint8_t keyboard_idle = 0;
 /* 0: Boot Protocol, 1: Report Protocol(default) */
 uint8_t keyboard_protocol = 1;
@@ -186,6 +191,9 @@ void raw_hid_receive( uint8_t *data, uint8_t length )
 	// Users should #include "raw_hid.h" in their own code
 	// and implement this function there. Leave this as weak linkage
 	// so users can opt to not handle data coming in.
+#ifdef INSTRUMENT_ENABLE
+	instrument_raw_hid_receive(data, length);
+#endif
 }
 
 /** \brief Raw HID Task
@@ -370,6 +378,78 @@ void EVENT_USB_Device_WakeUp()
 
 
 
+/*******************************************************************************
+ * Report queues
+ ******************************************************************************/
+/* The host driver functions queue their reports, and the start of frame
+ * interrupt writes them to the endpoints once the host has read the previous
+ * one, so a burst of reports (macros, taps) reaches the host one state at a
+ * time without keyboard_task waiting on the USB.
+ *
+ * When a queue is full, the sender waits for the interrupt to hand a report
+ * to the host, which paces long macros to the polling interval. The wait is
+ * bounded like the endpoint wait it replaces, so a host that stopped polling
+ * can't hang the keyboard.
+ */
+#define REPORT_QUEUE_WAIT_US 20
+#define REPORT_QUEUE_TIMEOUT (USB_POLLING_INTERVAL_MS * (2 * 1000 / REPORT_QUEUE_WAIT_US))
+
+static uint8_t keyboard_reports[USB_REPORT_QUEUE_SIZE][sizeof(report_keyboard_t)];
+static report_queue_t keyboard_queue = REPORT_QUEUE_INIT(keyboard_reports);
+
+#ifdef MOUSE_ENABLE
+static uint8_t mouse_reports[USB_REPORT_QUEUE_SIZE][sizeof(report_mouse_t)];
+static report_queue_t mouse_queue = REPORT_QUEUE_INIT(mouse_reports);
+#endif
+
+#ifdef EXTRAKEY_ENABLE
+static uint8_t extrakey_reports[USB_REPORT_QUEUE_SIZE][sizeof(report_extra_t)];
+static report_queue_t extrakey_queue = REPORT_QUEUE_INIT(extrakey_reports);
+#endif
+
+static void report_queue_send(report_queue_t *queue, const void *report, uint8_t endpoint, uint8_t length)
+{
+    uint16_t timeout = REPORT_QUEUE_TIMEOUT;
+
+    while (USB_DeviceState == DEVICE_STATE_Configured) {
+        if (report_queue_push(queue, report, endpoint, length))
+            return;
+        if (!timeout--) {
+            dprint("report queue: timeout\n");
+            return;
+        }
+        _delay_us(REPORT_QUEUE_WAIT_US);
+    }
+}
+
+/* Called from the start of frame interrupt */
+static void report_queue_flush(report_queue_t *queue)
+{
+    uint8_t endpoint, length;
+    const uint8_t *report = report_queue_peek(queue, &endpoint, &length);
+    if (!report)
+        return;
+
+    Endpoint_SelectEndpoint(endpoint);
+    if (!Endpoint_IsReadWriteAllowed())
+        return;
+
+    Endpoint_Write_Stream_LE(report, length, NULL);
+    Endpoint_ClearIN();
+    report_queue_pop(queue);
+}
+
+static void report_queues_clear(void)
+{
+    report_queue_clear(&keyboard_queue);
+#ifdef MOUSE_ENABLE
+    report_queue_clear(&mouse_queue);
+#endif
+#ifdef EXTRAKEY_ENABLE
+    report_queue_clear(&extrakey_queue);
+#endif
+}
+
 #ifdef CONSOLE_ENABLE
 static bool console_flush = false;
 #define CONSOLE_FLUSH_SET(b)   do { \
@@ -377,14 +457,28 @@ static bool console_flush = false;
     console_flush = b; \
   } \
 } while (0)
+#endif
 
 /** \brief Event USB Device Start Of Frame
  *
- * FIXME: Needs doc
+ * Writes the queued reports, and flushes the console every 50ms.
  * called every 1ms
  */
 void EVENT_USB_Device_StartOfFrame(void)
 {
+    uint8_t ep = Endpoint_GetCurrentEndpoint();
+
+    report_queue_flush(&keyboard_queue);
+#ifdef MOUSE_ENABLE
+    report_queue_flush(&mouse_queue);
+#endif
+#ifdef EXTRAKEY_ENABLE
+    report_queue_flush(&extrakey_queue);
+#endif
+
+    Endpoint_SelectEndpoint(ep);
+
+#ifdef CONSOLE_ENABLE
     static uint8_t count;
     if (++count % 50) return;
     count = 0;
@@ -392,9 +486,8 @@ void EVENT_USB_Device_StartOfFrame(void)
     if (!console_flush) return;
     Console_Task();
     console_flush = false;
-}
-
 #endif
+}
 
 /** \brief Event handler for the USB_ConfigurationChanged event.
  *
@@ -407,6 +500,11 @@ void EVENT_USB_Device_ConfigurationChanged(void)
 {
     bool ConfigSuccess = true;
 
+    /* Reports queued for the previous configuration are stale, and the host
+     * has to be told the current state again */
+    report_queues_clear();
+    host_forget_last_reports();
+
     /* Setup Keyboard HID Report Endpoints */
     ConfigSuccess &= ENDPOINT_CONFIG(KEYBOARD_IN_EPNUM, EP_TYPE_INTERRUPT, ENDPOINT_DIR_IN,
                                      KEYBOARD_EPSIZE, ENDPOINT_BANK_SINGLE);
@@ -603,7 +701,6 @@ static uint8_t keyboard_leds(void)
  */
 static void send_keyboard(report_keyboard_t *report)
 {
-    uint8_t timeout = 255;
     uint8_t where = where_to_send();
 
 #ifdef BLUETOOTH_ENABLE
@@ -634,32 +731,15 @@ static void send_keyboard(report_keyboard_t *report)
 #ifdef NKRO_ENABLE
     if (keyboard_protocol && keymap_config.nkro) {
         /* Report protocol - NKRO */
-        Endpoint_SelectEndpoint(NKRO_IN_EPNUM);
-
-        /* Check if write ready for a polling interval around 1ms */
-        while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(4);
-        if (!Endpoint_IsReadWriteAllowed()) return;
-
-        /* Write Keyboard Report Data */
-        Endpoint_Write_Stream_LE(report, NKRO_EPSIZE, NULL);
+        report_queue_send(&keyboard_queue, report, NKRO_IN_EPNUM, NKRO_EPSIZE);
     }
     else
 #endif
     {
         /* Boot protocol */
-        Endpoint_SelectEndpoint(KEYBOARD_IN_EPNUM);
-
-        /* Check if write ready for a polling interval around 10ms */
-        while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
-        if (!Endpoint_IsReadWriteAllowed()) return;
-
-        /* Write Keyboard Report Data */
-        Endpoint_Write_Stream_LE(report, KEYBOARD_EPSIZE, NULL);
+        report_queue_send(&keyboard_queue, report, KEYBOARD_IN_EPNUM, KEYBOARD_EPSIZE);
     }
 
-    /* Finalize the stream transfer to send the last packet */
-    Endpoint_ClearIN();
-
     keyboard_report_sent = *report;
 }
  
@@ -670,7 +750,6 @@ static void send_keyboard(report_keyboard_t *report)
 static void send_mouse(report_mouse_t *report)
 {
 #ifdef MOUSE_ENABLE
-    uint8_t timeout = 255;
     uint8_t where = where_to_send();
 
 #ifdef BLUETOOTH_ENABLE
@@ -696,18 +775,7 @@ static void send_mouse(report_mouse_t *report)
       return;
     }
 
-    /* Select the Mouse Report Endpoint */
-    Endpoint_SelectEndpoint(MOUSE_IN_EPNUM);
-
-    /* Check if write ready for a polling interval around 10ms */
-    while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
-    if (!Endpoint_IsReadWriteAllowed()) return;
-
-    /* Write Mouse Report Data */
-    Endpoint_Write_Stream_LE(report, sizeof(report_mouse_t), NULL);
-
-    /* Finalize the stream transfer to send the last packet */
-    Endpoint_ClearIN();
+    report_queue_send(&mouse_queue, report, MOUSE_IN_EPNUM, sizeof(report_mouse_t));
 #endif
 }
 
@@ -717,23 +785,13 @@ static void send_mouse(report_mouse_t *report)
  */
 static void send_system(uint16_t data)
 {
-    uint8_t timeout = 255;
-
-    if (USB_DeviceState != DEVICE_STATE_Configured)
-        return;
-
+#ifdef EXTRAKEY_ENABLE
     report_extra_t r = {
         .report_id = REPORT_ID_SYSTEM,
         .usage = data - SYSTEM_POWER_DOWN + 1
     };
-    Endpoint_SelectEndpoint(EXTRAKEY_IN_EPNUM);
-
-    /* Check if write ready for a polling interval around 10ms */
-    while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
-    if (!Endpoint_IsReadWriteAllowed()) return;
-
-    Endpoint_Write_Stream_LE(&r, sizeof(report_extra_t), NULL);
-    Endpoint_ClearIN();
+    report_queue_send(&extrakey_queue, &r, EXTRAKEY_IN_EPNUM, sizeof(report_extra_t));
+#endif
 }
 
 /** \brief Send Consumer
@@ -742,7 +800,6 @@ static void send_system(uint16_t data)
  */
 static void send_consumer(uint16_t data)
 {
-    uint8_t timeout = 255;
     uint8_t where = where_to_send();
 
 #ifdef BLUETOOTH_ENABLE
@@ -781,18 +838,13 @@ static void send_consumer(uint16_t data)
       return;
     }
 
+#ifdef EXTRAKEY_ENABLE
     report_extra_t r = {
         .report_id = REPORT_ID_CONSUMER,
         .usage = data
     };
-    Endpoint_SelectEndpoint(EXTRAKEY_IN_EPNUM);
-
-    /* Check if write ready for a polling interval around 10ms */
-    while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
-    if (!Endpoint_IsReadWriteAllowed()) return;
-
-    Endpoint_Write_Stream_LE(&r, sizeof(report_extra_t), NULL);
-    Endpoint_ClearIN();
+    report_queue_send(&extrakey_queue, &r, EXTRAKEY_IN_EPNUM, sizeof(report_extra_t));
+#endif
 }
 
 
@@ -1006,7 +1058,7 @@ static void setup_usb(void)
 
     USB_Init();
 
-    // for Console_Task
+    // for the report queues and Console_Task
     USB_Device_EnableSOFEvents();
     print_set_sendchar(sendchar);
 }
@@ -14,6 +14,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "lufa.h"
 #include "outputselect.h"
+#include "host.h"
 #ifdef MODULE_ADAFRUIT_BLE
     #include "adafruit_ble.h"
 #endif
@@ -27,6 +28,8 @@ uint8_t desired_output = OUTPUT_DEFAULT;
 void set_output(uint8_t output) {
     set_output_user(output);
     desired_output = output;
+    /* the new output hasn't seen the reports sent so far */
+    host_forget_last_reports();
 }
 
 /** \brief Set Output User
@@ -0,0 +1,66 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "report_queue.h"
+
+#define SLOT(index) ((index) % USB_REPORT_QUEUE_SIZE)
+
+// keeps the compiler from moving slot accesses past an index update
+#define BARRIER() __asm__ __volatile__ ("" ::: "memory")
+
+bool report_queue_push(report_queue_t *queue, const void *report, uint8_t endpoint, uint8_t length)
+{
+    uint8_t tail = queue->tail;
+    if ((uint8_t)(tail - queue->head) == USB_REPORT_QUEUE_SIZE)
+        return false;
+
+    uint8_t slot = SLOT(tail);
+    if (length > queue->report_size)
+        length = queue->report_size;
+    memcpy(queue->reports + slot * queue->report_size, report, length);
+    queue->endpoint[slot] = endpoint;
+    queue->length[slot] = length;
+    // publish the report only once it is complete
+    BARRIER();
+    queue->tail = tail + 1;
+    return true;
+}
+
+const uint8_t *report_queue_peek(report_queue_t *queue, uint8_t *endpoint, uint8_t *length)
+{
+    uint8_t head = queue->head;
+    if (head == queue->tail)
+        return NULL;
+
+    uint8_t slot = SLOT(head);
+    *endpoint = queue->endpoint[slot];
+    *length = queue->length[slot];
+    return queue->reports + slot * queue->report_size;
+}
+
+void report_queue_pop(report_queue_t *queue)
+{
+    if (queue->head != queue->tail) {
+        BARRIER();
+        queue->head++;
+    }
+}
+
+void report_queue_clear(report_queue_t *queue)
+{
+    queue->head = queue->tail;
+}
@@ -0,0 +1,60 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REPORT_QUEUE_H
+#define REPORT_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Reports waiting for the host to read them, one queue per HID endpoint.
+ *
+ * The main loop pushes and the start of frame interrupt pops. Each side only
+ * writes its own index, so neither needs to disable interrupts. A full queue
+ * refuses new reports rather than replacing one, so that every state the
+ * keyboard went through reaches the host.
+ */
+#ifndef USB_REPORT_QUEUE_SIZE
+#define USB_REPORT_QUEUE_SIZE 4
+#endif
+#if USB_REPORT_QUEUE_SIZE < 1 || USB_REPORT_QUEUE_SIZE > 128 || (USB_REPORT_QUEUE_SIZE & (USB_REPORT_QUEUE_SIZE - 1))
+#error "USB_REPORT_QUEUE_SIZE must be a power of two up to 128"
+#endif
+
+typedef struct {
+    uint8_t *reports;
+    uint8_t report_size;  // of a slot
+    // each report remembers where it goes, the keyboard switches between
+    // the boot and NKRO endpoints at runtime
+    uint8_t endpoint[USB_REPORT_QUEUE_SIZE];
+    uint8_t length[USB_REPORT_QUEUE_SIZE];
+    volatile uint8_t head;  // written by the consumer
+    volatile uint8_t tail;  // written by the producer
+} report_queue_t;
+
+/* buffer is a uint8_t [USB_REPORT_QUEUE_SIZE][report size] array */
+#define REPORT_QUEUE_INIT(buffer) { .reports = &(buffer)[0][0], .report_size = sizeof((buffer)[0]) }
+
+/* Producer side. Returns false when the queue is full */
+bool report_queue_push(report_queue_t *queue, const void *report, uint8_t endpoint, uint8_t length);
+
+/* Consumer side. Returns the oldest report, or NULL when there is none */
+const uint8_t *report_queue_peek(report_queue_t *queue, uint8_t *endpoint, uint8_t *length);
+void report_queue_pop(report_queue_t *queue);
+/* Drops every report, e.g. when the host reconfigures the device */
+void report_queue_clear(report_queue_t *queue);
+
+#endif
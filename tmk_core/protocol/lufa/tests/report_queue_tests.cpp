@@ -0,0 +1,127 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "protocol/lufa/report_queue.h"
+}
+
+#define REPORT_SIZE 8
+
+struct sent_report {
+    uint8_t endpoint;
+    std::vector<uint8_t> data;
+};
+
+class ReportQueue : public testing::Test {
+  protected:
+    uint8_t reports[USB_REPORT_QUEUE_SIZE][REPORT_SIZE] = {};
+    report_queue_t queue = REPORT_QUEUE_INIT(reports);
+    std::vector<sent_report> host;
+
+    // what the start of frame interrupt does when the host polls
+    void poll(void) {
+        uint8_t endpoint, length;
+        const uint8_t *report = report_queue_peek(&queue, &endpoint, &length);
+        if (report) {
+            host.push_back({endpoint, std::vector<uint8_t>(report, report + length)});
+            report_queue_pop(&queue);
+        }
+    }
+
+    // what report_queue_send does, the interrupt keeps polling while it waits
+    void send(const uint8_t *report, uint8_t endpoint, uint8_t length) {
+        while (!report_queue_push(&queue, report, endpoint, length)) {
+            poll();
+        }
+    }
+};
+
+TEST_F(ReportQueue, ReportsComeOutInOrder) {
+    uint8_t a[REPORT_SIZE] = {0, 0, 4};
+    uint8_t b[REPORT_SIZE] = {0, 0, 5};
+    EXPECT_TRUE(report_queue_push(&queue, a, 1, REPORT_SIZE));
+    EXPECT_TRUE(report_queue_push(&queue, b, 1, REPORT_SIZE));
+    poll();
+    poll();
+    poll();
+    ASSERT_EQ(host.size(), 2u);
+    EXPECT_EQ(host[0].data[2], 4);
+    EXPECT_EQ(host[1].data[2], 5);
+}
+
+TEST_F(ReportQueue, AFullQueueRefusesRatherThanReplaces) {
+    uint8_t report[REPORT_SIZE] = {};
+    for (uint8_t i = 0; i < USB_REPORT_QUEUE_SIZE; i++) {
+        report[2] = i;
+        EXPECT_TRUE(report_queue_push(&queue, report, 1, REPORT_SIZE));
+    }
+    report[2] = 0xFF;
+    EXPECT_FALSE(report_queue_push(&queue, report, 1, REPORT_SIZE));
+    for (uint8_t i = 0; i < USB_REPORT_QUEUE_SIZE; i++) {
+        poll();
+    }
+    ASSERT_EQ(host.size(), (size_t)USB_REPORT_QUEUE_SIZE);
+    EXPECT_EQ(host.back().data[2], USB_REPORT_QUEUE_SIZE - 1);
+}
+
+TEST_F(ReportQueue, EachReportKeepsItsEndpointAndLength) {
+    // NKRO was switched on while a boot report was still waiting
+    uint8_t boot[REPORT_SIZE] = {0, 0, 4};
+    uint8_t nkro[REPORT_SIZE] = {0, 0x10};
+    report_queue_push(&queue, boot, 1, REPORT_SIZE);
+    report_queue_push(&queue, nkro, 5, REPORT_SIZE - 2);
+    poll();
+    poll();
+    ASSERT_EQ(host.size(), 2u);
+    EXPECT_EQ(host[0].endpoint, 1);
+    EXPECT_EQ(host[0].data.size(), (size_t)REPORT_SIZE);
+    EXPECT_EQ(host[1].endpoint, 5);
+    EXPECT_EQ(host[1].data.size(), (size_t)REPORT_SIZE - 2);
+}
+
+TEST_F(ReportQueue, ClearDropsEverything) {
+    uint8_t report[REPORT_SIZE] = {};
+    report_queue_push(&queue, report, 1, REPORT_SIZE);
+    report_queue_clear(&queue);
+    poll();
+    EXPECT_TRUE(host.empty());
+}
+
+TEST_F(ReportQueue, ALongStringReachesTheHostWithoutLosingAKeystroke) {
+    // send_string without the send_string queue: a press and a release per
+    // character, back to back, while the host polls far less often
+    const char *str = "the quick brown fox jumps over the lazy dog";
+    std::vector<uint8_t> typed;
+    for (const char *c = str; *c; c++) {
+        uint8_t press[REPORT_SIZE] = {0, 0, (uint8_t)*c};
+        uint8_t release[REPORT_SIZE] = {};
+        send(press, 1, REPORT_SIZE);
+        send(release, 1, REPORT_SIZE);
+        typed.push_back(*c);
+    }
+    for (uint8_t i = 0; i < USB_REPORT_QUEUE_SIZE; i++) {
+        poll();
+    }
+
+    ASSERT_EQ(host.size(), typed.size() * 2);
+    for (size_t i = 0; i < typed.size(); i++) {
+        EXPECT_EQ(host[i * 2].data[2], typed[i]);
+        EXPECT_EQ(host[i * 2 + 1].data[2], 0);
+    }
+}
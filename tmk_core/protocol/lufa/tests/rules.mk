@@ -0,0 +1,3 @@
+lufa_report_queue_SRC := \
+	$(TMK_PATH)/protocol/lufa/tests/report_queue_tests.cpp \
+	$(TMK_PATH)/protocol/lufa/report_queue.c
@@ -0,0 +1,2 @@
+TEST_LIST +=\
+	lufa_report_queue
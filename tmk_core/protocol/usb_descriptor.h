@@ -254,6 +254,14 @@ typedef struct
 # error "There are not enough available endpoints to support all functions. Remove some in the rules.mk file.(MOUSEKEY, EXTRAKEY, CONSOLE, NKRO, MIDI, SERIAL, STENO)"
 #endif
 
+/* Polling interval of the keyboard, mouse and extrakey endpoints, in ms.
+ * The other HID endpoints are polled every 1 ms already, set this to 1 to
+ * get keys to the host as soon as they are reported.
+ */
+#ifndef USB_POLLING_INTERVAL_MS
+#define USB_POLLING_INTERVAL_MS     10
+#endif
+
 #define KEYBOARD_EPSIZE             8
 #define MOUSE_EPSIZE                8
 #define EXTRAKEY_EPSIZE             8